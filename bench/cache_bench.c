@@ -0,0 +1,147 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "arena/arena.h"
+#include "cache/cache.h"
+#include "cache/cache_internal.h"
+#include "heredoc/heredoc.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "script/script_internal.h"
+
+#define BENCH_COMMANDS 20000
+#define BENCH_ROUNDS 10
+
+/**
+ * @brief Generates a script mixing the constructs provisioning scripts are
+ * made of: plain commands, pipelines, and-or chains, expansions, subshells
+ * and here-documents.
+ */
+static char *bench_make_script(size_t commands, size_t *length) {
+  static const char *templates[] = {
+      "echo configuring step %zu of the installation\n",
+      "mkdir -p \"$HOME/build/%zu\" && cp -r ./assets/* \"$HOME/build/%zu\"\n",
+      "grep -v '^#' config.%zu | sort | uniq -c | head -n 20 > out.%zu\n",
+      "(cd /tmp && test -f lock.%zu) || touch lock.%zu\n",
+      "cat <<EOF > unit.%zu\n[Service]\nExecStart=/usr/bin/svc %zu\nEOF\n",
+  };
+  size_t capacity = commands * 96;
+  char *script = malloc(capacity);
+
+  *length = 0;
+  for (size_t i = 0; i < commands; ++i) {
+    *length += (size_t)snprintf(script + *length, capacity - *length,
+                                templates[i % 5], i, i);
+  }
+  return script;
+}
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Lexes and parses every command of `script`, as a run without the
+ * cache does.
+ */
+static size_t bench_parse(const char *script, size_t length, t_arena *arena) {
+  t_script_source source = {.input = script, .length = length};
+  size_t commands = 0;
+
+  while (source.offset < source.length) {
+    t_lexer *lexer = lexer_new_range(arena, source.input + source.offset,
+                                     source.length - source.offset);
+    t_ast *ast = parser_parse(parser_new(arena, lexer));
+    if (!ast) break;
+    source.offset += lexer_offset(lexer);
+    heredoc_skip(ast, script_source_read_line, &source);
+    arena_reset(arena);
+    ++commands;
+  }
+  return commands;
+}
+
+/**
+ * @brief Maps the stored image and decodes every command, as a run with a
+ * valid cache does.
+ */
+static size_t bench_load(const char *directory, const char *path,
+                         const struct stat *st, t_arena *arena) {
+  t_cache *cache = cache_open(directory, path, st);
+  t_cache_command command;
+  size_t commands = 0;
+
+  if (!cache) return 0;
+  while (cache_next(cache, arena, &command)) {
+    arena_reset(arena);
+    ++commands;
+  }
+  cache_close(cache);
+  return commands;
+}
+
+static void bench_report(const char *name, double elapsed, size_t commands,
+                         double baseline) {
+  double per_run = elapsed / BENCH_ROUNDS * 1e3;
+
+  printf("%-8s %9.3f ms/run  (%zu commands)", name, per_run, commands);
+  if (baseline > 0) printf("  %6.1fx", baseline / per_run);
+  printf("\n");
+}
+
+int main(void) {
+  char path[] = "/tmp/minishell-bench-XXXXXX";
+  char directory[] = "/tmp/minishell-bench-cache-XXXXXX";
+  size_t length;
+  char *script = bench_make_script(BENCH_COMMANDS, &length);
+  int fd = mkstemp(path);
+  struct stat st;
+
+  if (fd < 0 || !mkdtemp(directory) ||
+      write(fd, script, length) != (ssize_t)length || fstat(fd, &st) < 0) {
+    perror("cache_bench");
+    return EXIT_FAILURE;
+  }
+  close(fd);
+
+  t_arena *arena = arena_new(SCRIPT_ARENA_CHUNK_SIZE);
+  size_t commands = 0;
+  printf("cache: %zu byte script, %d rounds\n", length, BENCH_ROUNDS);
+
+  double start = bench_now();
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    commands = bench_parse(script, length, arena);
+  }
+  double cold = (bench_now() - start) / BENCH_ROUNDS * 1e3;
+  bench_report("parse", cold * BENCH_ROUNDS / 1e3, commands, 0);
+
+  start = bench_now();
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    t_script_source source = {.input = script, .length = length};
+    cache_close(script_compile(&source, round ? NULL : directory, path, &st));
+  }
+  bench_report("compile", bench_now() - start, commands, cold);
+
+  start = bench_now();
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    commands = bench_load(directory, path, &st, arena);
+  }
+  bench_report("load", bench_now() - start, commands, cold);
+
+  char file[PATH_MAX];
+  if (cache_file(file, sizeof(file), directory, path)) unlink(file);
+  rmdir(directory);
+  unlink(path);
+  arena_free(arena);
+  free(script);
+  return EXIT_SUCCESS;
+}
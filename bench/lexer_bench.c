@@ -0,0 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arena/arena.h"
+#include "lexer/lexer.h"
+#include "lexer/lexer_internal.h"
+
+#define BENCH_LINE_SIZE (8 << 20)
+#define BENCH_ROUNDS 10
+
+/**
+ * @brief Builds a long generated command line of `word_length` byte words
+ * separated by blanks, with a pipe every 64 words.
+ */
+static char *bench_make_line(size_t size, size_t word_length) {
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789/-._=";
+  char *line = malloc(size + 1);
+  size_t length = 0;
+
+  for (size_t i = 0; length + word_length + 3 <= size; ++i) {
+    for (size_t k = 0; k < word_length; ++k) {
+      line[length++] = alphabet[(i + k) % (sizeof(alphabet) - 1)];
+    }
+    if (i % 64 == 63) {
+      memcpy(line + length, " | ", 3);
+      length += 3;
+    } else {
+      line[length++] = ' ';
+    }
+  }
+  line[length] = '\0';
+  return line;
+}
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_scanner(const char *name, t_lexer_scanner scanner,
+                          const char *line, size_t length) {
+  size_t words = 0;
+  double start = bench_now();
+
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    for (size_t position = 0; position < length; ++position) {
+      position = scanner(line, position, length);
+      ++words;
+    }
+  }
+
+  double elapsed = bench_now() - start;
+  printf("%-8s %8.2f MiB/s  (%zu stops)\n", name,
+         BENCH_ROUNDS * length / elapsed / (1 << 20), words / BENCH_ROUNDS);
+}
+
+static void bench_lexer(const char *line, size_t length) {
+  t_arena *arena = arena_new(16384);
+  size_t tokens = 0;
+  double start = bench_now();
+
+  for (int round = 0; round < BENCH_ROUNDS; ++round) {
+    t_lexer *lexer = lexer_new(arena, line);
+    while (lexer_next_token(lexer)->type != TOKEN_EOF) ++tokens;
+    arena_reset(arena);
+  }
+
+  double elapsed = bench_now() - start;
+  printf("%-8s %8.2f MiB/s  (%zu tokens)\n", "lexer",
+         BENCH_ROUNDS * length / elapsed / (1 << 20), tokens / BENCH_ROUNDS);
+  arena_free(arena);
+}
+
+int main(void) {
+  static const size_t word_lengths[] = {4, 8, 16, 24, 32, 64, 256, 4096};
+
+  lexer_scanner();
+  for (size_t i = 0; i < sizeof(word_lengths) / sizeof(word_lengths[0]); ++i) {
+    char *line = bench_make_line(BENCH_LINE_SIZE, word_lengths[i]);
+    size_t length = strlen(line);
+
+    printf("lexer: %zu byte line of %zu byte words, %d rounds\n", length,
+           word_lengths[i], BENCH_ROUNDS);
+    bench_scanner("scalar", lexer_skip_plain_scalar, line, length);
+#if defined(__x86_64__) || defined(__i386__)
+    bench_scanner("sse2", lexer_skip_plain_sse2, line, length);
+    if (__builtin_cpu_supports("avx2")) {
+      bench_scanner("avx2", lexer_skip_plain_avx2, line, length);
+    }
+#endif
+    bench_lexer(line, length);
+    free(line);
+  }
+
+  return EXIT_SUCCESS;
+}
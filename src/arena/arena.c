@@ -0,0 +1,98 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena_internal.h"
+#include "ft_stdlib.h"
+
+#define ARENA_ALIGN_UP(size) \
+  (((size) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+t_arena *arena_new(size_t chunk_size) {
+  t_arena *arena = ft_expect(malloc(sizeof(t_arena)), __func__);
+  *arena = (t_arena){
+      .chunks = arena_chunk_new(chunk_size),
+      .chunk_size = chunk_size,
+  };
+  return arena;
+}
+
+void arena_free(t_arena *arena) {
+  t_arena_chunk *chunk = arena->chunks;
+
+  while (chunk) {
+    t_arena_chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
+
+void *arena_alloc(t_arena *arena, size_t size) {
+  size = ARENA_ALIGN_UP(size);
+
+  t_arena_chunk *chunk = arena->chunks;
+  if (chunk->size - chunk->used < size) {
+    if (size > arena->chunk_size) {
+      // Oversized requests get their own chunk behind the current one, so the
+      // space left in the current chunk stays usable.
+      t_arena_chunk *large = arena_chunk_new(size);
+      large->next = chunk->next;
+      chunk->next = large;
+      large->used = size;
+      return large->data;
+    }
+    chunk = arena_chunk_new(arena->chunk_size);
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+  }
+
+  void *ptr = (char *)chunk->data + chunk->used;
+  chunk->used += size;
+  return ptr;
+}
+
+void *arena_calloc(t_arena *arena, size_t size) {
+  return memset(arena_alloc(arena, size), 0, size);
+}
+
+void arena_reset(t_arena *arena) {
+  t_arena_chunk *keep = NULL;
+  t_arena_chunk *chunk = arena->chunks;
+
+  while (chunk) {
+    t_arena_chunk *next = chunk->next;
+    if (!keep && chunk->size == arena->chunk_size) {
+      keep = chunk;
+    } else {
+      free(chunk);
+    }
+    chunk = next;
+  }
+
+  if (!keep) keep = arena_chunk_new(arena->chunk_size);
+  keep->next = NULL;
+  keep->used = 0;
+  arena->chunks = keep;
+}
+
+size_t arena_used(const t_arena *arena) {
+  size_t used = sizeof(t_arena);
+
+  for (const t_arena_chunk *chunk = arena->chunks; chunk; chunk = chunk->next) {
+    used += sizeof(t_arena_chunk) + chunk->used;
+  }
+  return used;
+}
+
+t_arena_chunk *arena_chunk_new(size_t size) {
+  t_arena_chunk *chunk =
+      ft_expect(malloc(sizeof(t_arena_chunk) + size), __func__);
+  *chunk = (t_arena_chunk){
+      .next = NULL,
+      .size = size,
+      .used = 0,
+  };
+  return chunk;
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct s_arena t_arena;
+
+/**
+ * @brief Creates a bump allocator that hands out memory from large chunks.
+ *
+ * Everything allocated from an arena is released at once by `arena_reset` or
+ * `arena_free`; individual allocations are never freed.
+ *
+ * @param chunk_size The size of the regular chunks, in bytes.
+ * @return The new arena.
+ */
+t_arena *arena_new(size_t chunk_size);
+
+/**
+ * @brief Releases the arena and every allocation made from it.
+ */
+void arena_free(t_arena *arena);
+
+/**
+ * @brief Allocates `size` bytes aligned for any object type.
+ *
+ * Requests larger than the chunk size get a dedicated chunk.
+ */
+void *arena_alloc(t_arena *arena, size_t size);
+
+/**
+ * @brief Allocates `size` zero-initialized bytes.
+ */
+void *arena_calloc(t_arena *arena, size_t size);
+
+/**
+ * @brief Invalidates every allocation made from the arena.
+ *
+ * The first regular chunk is kept for reuse and every other chunk is returned
+ * to the system, so a long session does not hold on to the peak of a single
+ * large line.
+ */
+void arena_reset(t_arena *arena);
+
+/**
+ * @brief Returns the memory handed out by the arena and its bookkeeping, in
+ * bytes; the unused tails of its chunks are not counted.
+ */
+size_t arena_used(const t_arena *arena);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef ARENA_INTERNAL_H
+#define ARENA_INTERNAL_H
+
+#include <stddef.h>
+
+#include "arena.h"
+
+typedef struct s_arena_chunk {
+  struct s_arena_chunk *next;
+  size_t size;
+  size_t used;
+  max_align_t data[];
+} t_arena_chunk;
+
+struct s_arena {
+  t_arena_chunk *chunks;
+  size_t chunk_size;
+};
+
+t_arena_chunk *arena_chunk_new(size_t size);
+
+#endif
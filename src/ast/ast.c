@@ -2,67 +2,26 @@
 
 #include <stddef.h>
 #include <stdio.h>
-#include <stdlib.h>
 
+#include "arena/arena.h"
 #include "ft_ansi.h"
-#include "ft_stdlib.h"
 
 static void $ast_print(t_ast *ast, int depth);
 
-t_ast *ast_new(t_ast ast) {
-  t_ast *new_ast = ft_expect(malloc(sizeof(t_ast)), __func__);
+t_ast *ast_new(t_arena *arena, t_ast ast) {
+  t_ast *new_ast = arena_alloc(arena, sizeof(t_ast));
   *new_ast = ast;
   return new_ast;
 }
 
-void ast_free(t_ast *ast) {
-  if (!ast) return;
-
-  switch (ast->type) {
-    case AST_LIST:
-      ast_free(ast->list.left);
-      ast_free(ast->list.right);
-      break;
-    case AST_AND_OR:
-      ast_free(ast->and_or.left);
-      ast_free(ast->and_or.right);
-      break;
-    case AST_PIPE_SEQUENCE:
-      ast_free(ast->pipe_sequence.left);
-      ast_free(ast->pipe_sequence.right);
-      break;
-    case AST_SUBSHELL:
-      ast_free(ast->subshell.and_or);
-      break;
-    case AST_SIMPLE_COMMAND:
-      ast_free(ast->simple_command.cmd_prefix);
-      ast_free(ast->simple_command.cmd_suffix);
-      break;
-    case AST_CMD_PREFIX:
-      ast_free(ast->cmd_prefix.io_file);
-      ast_free(ast->cmd_prefix.cmd_prefix);
-      break;
-    case AST_CMD_SUFFIX:
-      ast_free(ast->cmd_suffix.io_file);
-      ast_free(ast->cmd_suffix.cmd_suffix);
-      break;
-    case AST_IO_FILE:
-      break;
-  }
-
-  free(ast);
-}
-
 const char *ast_type_to_string(t_ast_type type) {
   return (const char *[]){
       [AST_LIST] = "list",
       [AST_AND_OR] = "and-or",
       [AST_PIPE_SEQUENCE] = "pipe-sequence",
       [AST_SUBSHELL] = "subshell",
+      [AST_BACKGROUND] = "background",
       [AST_SIMPLE_COMMAND] = "simple-command",
-      [AST_CMD_PREFIX] = "cmd-prefix",
-      [AST_CMD_SUFFIX] = "cmd-suffix",
-      [AST_IO_FILE] = "io-file",
   }[type];
 }
 
@@ -87,74 +46,73 @@ static void $ast_print(t_ast *ast, int depth) {
     case AST_LIST:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      $ast_print(ast->list.left, depth + 1);
-      $ast_print(ast->list.right, depth + 1);
+      for (size_t i = 0; i < ast->list.count; ++i) {
+        $ast_print(ast->list.children[i], depth + 1);
+      }
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
     case AST_AND_OR:
-      printf("%*s<%s%s\033[0m " ANSI_CYAN "op" ANSI_RESET "=" ANSI_YELLOW
-             "\"%s\"" ANSI_RESET ">\n",
-             depth * indent_size, "", $get_color(depth),
-             ast_type_to_string(ast->type),
-             token_type_to_string(ast->and_or.op->type));
-      $ast_print(ast->and_or.left, depth + 1);
-      $ast_print(ast->and_or.right, depth + 1);
-      printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
-             ast_type_to_string(ast->type));
-      break;
-    case AST_PIPE_SEQUENCE:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      $ast_print(ast->pipe_sequence.left, depth + 1);
-      $ast_print(ast->pipe_sequence.right, depth + 1);
+      for (size_t i = 0; i < ast->and_or.count; ++i) {
+        if (ast->and_or.ops[i]) {
+          printf("%*s" ANSI_CYAN "op" ANSI_RESET "=" ANSI_YELLOW
+                 "\"%s\"" ANSI_RESET "\n",
+                 (depth + 1) * indent_size, "",
+                 token_type_to_string(ast->and_or.ops[i]->type));
+        }
+        $ast_print(ast->and_or.children[i], depth + 1);
+      }
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
-    case AST_SUBSHELL:
+    case AST_PIPE_SEQUENCE:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      $ast_print(ast->subshell.and_or, depth + 1);
+      if (ast->pipe_sequence.timing != AST_TIMING_NONE) {
+        printf("%*s" ANSI_CYAN "timing" ANSI_RESET "=" ANSI_YELLOW
+               "\"%s\"" ANSI_RESET "\n",
+               (depth + 1) * indent_size, "",
+               ast->pipe_sequence.timing == AST_TIMING_JSON ? "json" : "text");
+      }
+      for (size_t i = 0; i < ast->pipe_sequence.count; ++i) {
+        $ast_print(ast->pipe_sequence.children[i], depth + 1);
+      }
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
-    case AST_SIMPLE_COMMAND:
+    case AST_SUBSHELL:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      printf("%*s%s\n", (depth + 1) * indent_size, "",
-             ast->simple_command.cmd_name);
-      $ast_print(ast->simple_command.cmd_prefix, depth + 1);
-      $ast_print(ast->simple_command.cmd_suffix, depth + 1);
+      $ast_print(ast->subshell.list, depth + 1);
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
-    case AST_CMD_PREFIX:
+    case AST_BACKGROUND:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      $ast_print(ast->cmd_prefix.io_file, depth + 1);
-      $ast_print(ast->cmd_prefix.cmd_prefix, depth + 1);
+      $ast_print(ast->background.command, depth + 1);
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
-    case AST_CMD_SUFFIX:
+    case AST_SIMPLE_COMMAND:
       printf("%*s<%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
-      $ast_print(ast->cmd_suffix.io_file, depth + 1);
-      if (ast->cmd_suffix.word) {
-        printf("%*s%s\n", (depth + 1) * indent_size, "", ast->cmd_suffix.word);
+      for (size_t i = 0; i < ast->simple_command.argc; ++i) {
+        printf("%*s%s\n", (depth + 1) * indent_size, "",
+               ast->simple_command.argv[i]);
+      }
+      for (size_t i = 0; i < ast->simple_command.io_file_count; ++i) {
+        const t_io_file *io_file = &ast->simple_command.io_files[i];
+        printf("%*s<%sio-file\033[0m " ANSI_CYAN "op" ANSI_RESET "=" ANSI_YELLOW
+               "\"%s\"" ANSI_RESET " " ANSI_CYAN "filename" ANSI_RESET
+               "=" ANSI_YELLOW "\"%s\"" ANSI_RESET " />\n",
+               (depth + 1) * indent_size, "", $get_color(depth + 1),
+               token_type_to_string(io_file->op->type), io_file->filename);
       }
-      $ast_print(ast->cmd_suffix.cmd_suffix, depth + 1);
       printf("%*s</%s%s\033[0m>\n", depth * indent_size, "", $get_color(depth),
              ast_type_to_string(ast->type));
       break;
-    case AST_IO_FILE:
-      printf("%*s<%s%s\033[0m " ANSI_CYAN "op" ANSI_RESET "=" ANSI_YELLOW
-             "\"%s\"" ANSI_RESET " " ANSI_CYAN "filename" ANSI_RESET
-             "=" ANSI_YELLOW "\"%s\"" ANSI_RESET " />\n",
-             depth * indent_size, "", $get_color(depth),
-             ast_type_to_string(ast->type),
-             token_type_to_string(ast->io_file.op->type),
-             ast->io_file.filename);
-      break;
   }
 }
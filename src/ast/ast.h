@@ -1,6 +1,10 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "arena/arena.h"
 #include "token/token.h"
 
 typedef enum e_ast_type {
@@ -8,54 +12,87 @@ typedef enum e_ast_type {
   AST_AND_OR,
   AST_PIPE_SEQUENCE,
   AST_SUBSHELL,
+  AST_BACKGROUND,
   AST_SIMPLE_COMMAND,
-  AST_CMD_PREFIX,
-  AST_CMD_SUFFIX,
-  AST_IO_FILE,
 } t_ast_type;
 
+/**
+ * @brief How a pipeline prefixed with the `time` reserved word reports what
+ * it used: as a table, or as one JSON object with `time -j`.
+ */
+typedef enum e_ast_timing {
+  AST_TIMING_NONE,
+  AST_TIMING_TEXT,
+  AST_TIMING_JSON,
+} t_ast_timing;
+
+/**
+ * @brief A redirection of a simple command.
+ *
+ * For a here-document, `filename` is the delimiter and `fd` the read end of
+ * the collected body; `fd` is -1 otherwise. `expansion` is set when the
+ * filename expands parameters; a delimiter is never expanded. `quoted` is
+ * set when any part of the filename was quoted: the body of a here-document
+ * whose delimiter is quoted is not expanded.
+ */
+typedef struct s_io_file {
+  const t_token *op;
+  const char *filename;
+  const t_word_expansion *expansion;
+  int fd;
+  bool quoted;
+} t_io_file;
+
+/**
+ * @brief A node of the abstract syntax tree.
+ *
+ * Lists, and-or chains and pipe sequences are n-ary: their operands are kept
+ * in one contiguous `children` array. In an and-or chain, `ops[i]` is the
+ * operator between `children[i - 1]` and `children[i]`; `ops[0]` is NULL.
+ *
+ * A pipe sequence usually has at least two stages; a timed one is kept even
+ * with a single stage, to carry its `timing`.
+ *
+ * A simple command is stored ready to execute: `argv` is NULL-terminated and
+ * its redirections are kept in order in `io_files`. `argc` is 0 for a command
+ * made only of redirections. `expansions` is NULL unless a word expands
+ * parameters; it then holds the expansion of each word, NULL for the words
+ * that are used as written.
+ */
 typedef struct s_ast {
   t_ast_type type;
   union {
     struct {
-      struct s_ast *left;
-      struct s_ast *right;
+      struct s_ast **children;
+      size_t count;
     } list;
     struct {
-      struct s_ast *left;
-      t_token *op;
-      struct s_ast *right;
+      struct s_ast **children;
+      const t_token **ops;
+      size_t count;
     } and_or;
     struct {
-      struct s_ast *left;
-      struct s_ast *right;
+      struct s_ast **children;
+      size_t count;
+      t_ast_timing timing;
     } pipe_sequence;
     struct {
-      struct s_ast *and_or;
+      struct s_ast *list;
     } subshell;
     struct {
-      struct s_ast *cmd_prefix;
-      const char *cmd_name;
-      struct s_ast *cmd_suffix;
-    } simple_command;
+      struct s_ast *command;
+    } background;
     struct {
-      struct s_ast *io_file;
-      struct s_ast *cmd_prefix;
-    } cmd_prefix;
-    struct {
-      struct s_ast *io_file;
-      const char *word;
-      struct s_ast *cmd_suffix;
-    } cmd_suffix;
-    struct {
-      t_token *op;
-      const char *filename;
-    } io_file;
+      const char **argv;
+      size_t argc;
+      const t_word_expansion **expansions;
+      t_io_file *io_files;
+      size_t io_file_count;
+    } simple_command;
   };
 } t_ast;
 
-t_ast *ast_new(t_ast ast);
-void ast_free(t_ast *ast);
+t_ast *ast_new(t_arena *arena, t_ast ast);
 const char *ast_type_to_string(t_ast_type type);
 void ast_print(t_ast *ast);
 
@@ -0,0 +1,116 @@
+#include "builtin.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "ft_stdlib.h"
+#include "minishell.h"
+
+#define BUILTIN_ENTRY(name, flags) {#name, builtin_##name, flags},
+
+// `.` is not an identifier, so the alias of `source` is listed apart
+static const t_builtin g_builtins[] = {
+    BUILTIN_LIST(BUILTIN_ENTRY){".", builtin_source, 0},
+};
+
+const t_builtin *builtin_find(const char *name) {
+  const t_builtin_registry *registry = builtin_registry();
+  const t_builtin *builtin =
+      registry->slots[builtin_hash_name(name, registry->seed) & registry->mask];
+
+  if (builtin && strcmp(builtin->name, name) == 0) return builtin;
+  return NULL;
+}
+
+t_builtin_registry *builtin_registry(void) {
+  static t_builtin_registry registry = {.slots = NULL};
+
+  if (!registry.slots) {
+    registry.count = sizeof(g_builtins) / sizeof(*g_builtins);
+    registry.builtins =
+        ft_expect(malloc(sizeof(g_builtins)), __func__);
+    memcpy(registry.builtins, g_builtins, sizeof(g_builtins));
+    builtin_registry_build(&registry);
+  }
+  return &registry;
+}
+
+void builtin_register(const t_builtin *builtin) {
+  t_builtin_registry *registry = builtin_registry();
+
+  // A loaded builtin replaces the one it shares a name with
+  for (size_t i = 0; i < registry->count; ++i) {
+    if (strcmp(registry->builtins[i].name, builtin->name) == 0) {
+      registry->builtins[i] = *builtin;
+      return;
+    }
+  }
+
+  registry->builtins = ft_expect(
+      realloc(registry->builtins, (registry->count + 1) * sizeof(t_builtin)),
+      __func__);
+  registry->builtins[registry->count++] = *builtin;
+  builtin_registry_build(registry);
+}
+
+/**
+ * @brief Tries to place every builtin in its own slot with `seed`.
+ *
+ * @return false on the first collision.
+ */
+static bool builtin_registry_place(t_builtin_registry *registry,
+                                   unsigned seed) {
+  const t_builtin *builtins = registry->builtins;
+
+  memset(registry->slots, 0, (registry->mask + 1) * sizeof(t_builtin *));
+  for (size_t i = 0; i < registry->count; ++i) {
+    size_t slot = builtin_hash_name(builtins[i].name, seed) & registry->mask;
+    if (registry->slots[slot]) return false;
+    registry->slots[slot] = &builtins[i];
+  }
+  registry->seed = seed;
+  return true;
+}
+
+void builtin_registry_build(t_builtin_registry *registry) {
+  // A table four times larger than the set finds a seed in a few attempts
+  size_t size = 1;
+  while (size < registry->count * 4) size *= 2;
+
+  while (true) {
+    free(registry->slots);
+    registry->slots = ft_expect(calloc(size, sizeof(t_builtin *)), __func__);
+    registry->mask = size - 1;
+    for (unsigned seed = 0; seed < BUILTIN_SEED_ATTEMPTS; ++seed) {
+      if (builtin_registry_place(registry, seed)) return;
+    }
+    size *= 2;
+  }
+}
+
+unsigned builtin_hash_name(const char *name, unsigned seed) {
+  // FNV-1a, with the seed folded into the offset basis
+  uint32_t hash = 2166136261u ^ seed;
+
+  while (*name) {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
+int builtin_flush(t_writer *writer, const char *name) {
+  if (writer_flush(writer) == -1) {
+    // A reader that went away is not worth a message, as with SIGPIPE
+    if (errno == EPIPE) return EXIT_FAILURE;
+    fprintf(stderr, "%s: %s: write error: %s\n", MINISHELL_NAME, name,
+            strerror(errno));
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
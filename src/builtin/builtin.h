@@ -0,0 +1,47 @@
+#ifndef BUILTIN_H
+#define BUILTIN_H
+
+#include "environment/environment.h"
+#include "evaluator/evaluator.h"
+
+/**
+ * @brief Runs a builtin command inside the shell process.
+ *
+ * Builtins read and write the context's descriptors directly; they neither
+ * close them nor touch the shell's standard streams.
+ *
+ * @param argv The NULL-terminated arguments, starting with the name.
+ * @param environment The shell variables.
+ * @param io The descriptors the command reads from and writes to.
+ * @return The exit status of the command.
+ */
+typedef int (*t_builtin_handler)(const char **argv, t_environment *environment,
+                                 t_io_context io);
+
+/**
+ * @brief Properties the evaluator needs to know about a builtin.
+ *
+ * `BUILTIN_NO_FORK` marks builtins that never read their input nor change
+ * the shell's state, so they may run inside the shell even as a pipeline
+ * stage.
+ */
+typedef enum e_builtin_flags {
+  BUILTIN_NO_FORK = 1 << 0,
+} t_builtin_flags;
+
+typedef struct s_builtin {
+  const char *name;
+  t_builtin_handler handler;
+  unsigned flags;
+} t_builtin;
+
+/**
+ * @brief Looks up the builtin called `name`.
+ *
+ * Costs one hash of `name` and one string comparison.
+ *
+ * @return Its descriptor, or NULL if `name` is not a builtin.
+ */
+const t_builtin *builtin_find(const char *name);
+
+#endif
@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+
+int builtin_cd(const char **argv, t_environment *environment,
+               t_io_context io) {
+  (void)environment;
+  (void)io;
+
+  if (!argv[1]) {
+    fprintf(stderr, "%s: cd: missing argument\n", MINISHELL_NAME);
+    return EXIT_FAILURE;
+  }
+  if (chdir(argv[1]) == -1) {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
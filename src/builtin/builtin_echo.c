@@ -0,0 +1,27 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+
+int builtin_echo(const char **argv, t_environment *environment,
+                 t_io_context io) {
+  (void)environment;
+
+  t_writer writer;
+  bool newline = true;
+
+  ++argv;
+  if (*argv && strcmp(*argv, "-n") == 0) {
+    newline = false;
+    ++argv;
+  }
+
+  writer_init(&writer, io.out_fd);
+  for (; *argv; ++argv) {
+    writer_puts(&writer, *argv);
+    if (argv[1]) writer_putc(&writer, ' ');
+  }
+  if (newline) writer_putc(&writer, '\n');
+
+  return builtin_flush(&writer, "echo");
+}
@@ -0,0 +1,80 @@
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+
+/**
+ * @brief Lists every registered builtin, one `enable name` per line.
+ */
+static int builtin_enable_print(t_io_context io) {
+  const t_builtin_registry *registry = builtin_registry();
+  t_writer writer;
+
+  writer_init(&writer, io.out_fd);
+  for (size_t i = 0; i < registry->count; ++i) {
+    writer_puts(&writer, "enable ");
+    writer_puts(&writer, registry->builtins[i].name);
+    writer_putc(&writer, '\n');
+  }
+  return builtin_flush(&writer, "enable");
+}
+
+/**
+ * @brief Registers the builtin `name` exported by the shared object
+ * `handle`.
+ *
+ * The object exports a `t_builtin` named after the builtin, with dashes
+ * turned into underscores and `BUILTIN_SYMBOL_SUFFIX` appended.
+ */
+static int builtin_enable_load(void *handle, const char *path,
+                               const char *name) {
+  size_t length = strlen(name);
+  char symbol[length + sizeof(BUILTIN_SYMBOL_SUFFIX)];
+
+  for (size_t i = 0; i < length; ++i) {
+    symbol[i] = name[i] == '-' ? '_' : name[i];
+  }
+  memcpy(symbol + length, BUILTIN_SYMBOL_SUFFIX,
+         sizeof(BUILTIN_SYMBOL_SUFFIX));
+
+  const t_builtin *builtin = dlsym(handle, symbol);
+  if (!builtin || !builtin->handler || strcmp(builtin->name, name) != 0) {
+    fprintf(stderr, "%s: enable: %s: no builtin `%s' in %s\n",
+            MINISHELL_NAME, name, name, path);
+    return EXIT_FAILURE;
+  }
+
+  builtin_register(builtin);
+  return EXIT_SUCCESS;
+}
+
+int builtin_enable(const char **argv, t_environment *environment,
+                   t_io_context io) {
+  (void)environment;
+
+  if (!argv[1]) return builtin_enable_print(io);
+
+  if (strcmp(argv[1], "-f") != 0 || !argv[2] || !argv[3]) {
+    fprintf(stderr, "%s: enable: usage: enable [-f file name...]\n",
+            MINISHELL_NAME);
+    return EXIT_FAILURE;
+  }
+
+  // The object stays loaded for as long as its builtins may be called
+  void *handle = dlopen(argv[2], RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    fprintf(stderr, "%s: enable: %s\n", MINISHELL_NAME, dlerror());
+    return EXIT_FAILURE;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (size_t i = 3; argv[i]; ++i) {
+    if (builtin_enable_load(handle, argv[2], argv[i]) != EXIT_SUCCESS) {
+      status = EXIT_FAILURE;
+    }
+  }
+  return status;
+}
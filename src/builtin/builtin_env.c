@@ -0,0 +1,17 @@
+#include "builtin_internal.h"
+
+int builtin_env(const char **argv, t_environment *environment,
+                t_io_context io) {
+  (void)argv;
+
+  t_writer writer;
+
+  // Exactly what a launched command would receive
+  writer_init(&writer, io.out_fd);
+  for (char **entry = environment_envp(environment); *entry; ++entry) {
+    writer_puts(&writer, *entry);
+    writer_putc(&writer, '\n');
+  }
+
+  return builtin_flush(&writer, "env");
+}
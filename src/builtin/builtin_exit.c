@@ -0,0 +1,31 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+#include "script/script.h"
+
+int builtin_exit(const char **argv, t_environment *environment,
+                 t_io_context io) {
+  (void)io;
+
+  // Without an operand the shell exits with the status of the last command
+  int status = environment->status;
+  if (argv[1]) {
+    char *end;
+    errno = 0;
+    long long value = strtoll(argv[1], &end, 10);
+    if (*end || end == argv[1] || errno == ERANGE) {
+      fprintf(stderr, "%s: exit: %s: numeric argument required\n",
+              MINISHELL_NAME, argv[1]);
+      exit(SCRIPT_STATUS_USAGE);
+    }
+    if (argv[2]) {
+      fprintf(stderr, "%s: exit: too many arguments\n", MINISHELL_NAME);
+      return EXIT_FAILURE;
+    }
+    status = (int)(value & 0xff);
+  }
+  exit(status);
+}
@@ -0,0 +1,44 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+
+/**
+ * @brief Checks whether the first `length` bytes of `operand` are a valid
+ * variable name.
+ */
+static bool builtin_export_is_name(const char *operand, size_t length) {
+  if (length == 0 || !(isalpha((unsigned char)*operand) || *operand == '_')) {
+    return false;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if (!(isalnum((unsigned char)operand[i]) || operand[i] == '_')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int builtin_export(const char **argv, t_environment *environment,
+                   t_io_context io) {
+  // Without operands the exported variables are listed, as `env` does
+  if (!argv[1]) return builtin_env(argv, environment, io);
+
+  int status = EXIT_SUCCESS;
+  for (size_t i = 1; argv[i]; ++i) {
+    size_t length = strcspn(argv[i], "=");
+    if (!builtin_export_is_name(argv[i], length)) {
+      fprintf(stderr, "%s: export: `%s': not a valid identifier\n",
+              MINISHELL_NAME, argv[i]);
+      status = EXIT_FAILURE;
+    } else if (argv[i][length] == '=' ||
+               !environment_get(environment, argv[i])) {
+      // A bare name keeps the value it already has
+      environment_set(environment, argv[i]);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "ft_hashmap.h"
+#include "minishell.h"
+
+/**
+ * @brief Lists the remembered command locations, one `name\tpath` per line.
+ */
+static int builtin_hash_print(t_environment *environment, t_io_context io) {
+  t_writer writer;
+
+  writer_init(&writer, io.out_fd);
+  t_hashmap_iterator it = ft_hshbegin(environment->commands);
+  while (ft_hshnext(&it)) {
+    writer_puts(&writer, it.key);
+    writer_putc(&writer, '\t');
+    writer_puts(&writer, *(char *)it.value ? it.value : "(not found)");
+    writer_putc(&writer, '\n');
+  }
+
+  return builtin_flush(&writer, "hash");
+}
+
+int builtin_hash(const char **argv, t_environment *environment,
+                 t_io_context io) {
+  if (!argv[1]) return builtin_hash_print(environment, io);
+
+  if (strcmp(argv[1], "-r") == 0) {
+    environment_commands_reset(environment);
+    return EXIT_SUCCESS;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (size_t i = 1; argv[i]; ++i) {
+    if (!environment_command_path(environment, argv[i])) {
+      fprintf(stderr, "%s: hash: %s: not found\n", MINISHELL_NAME, argv[i]);
+      status = EXIT_FAILURE;
+    }
+  }
+  return status;
+}
@@ -0,0 +1,139 @@
+#ifndef BUILTIN_INTERNAL_H
+#define BUILTIN_INTERNAL_H
+
+#include "builtin.h"
+#include "writer/writer.h"
+
+/**
+ * @brief The builtins compiled into the shell, as `X(name, flags)`.
+ *
+ * Registering a builtin takes a line here and a `builtin_<name>` handler; the
+ * lookup table is derived from this list.
+ */
+#define BUILTIN_LIST(X)    \
+  X(cd, 0)                 \
+  X(echo, BUILTIN_NO_FORK) \
+  X(env, BUILTIN_NO_FORK)  \
+  X(enable, 0)             \
+  X(exit, 0)               \
+  X(export, 0)             \
+  X(hash, 0)               \
+  X(jobs, 0)               \
+  X(parallel, 0)           \
+  X(parsecache, 0)         \
+  X(pwd, BUILTIN_NO_FORK)  \
+  X(source, 0)             \
+  X(unset, 0)              \
+  X(wait, 0)
+
+/**
+ * @brief Attempts at finding a collision-free seed before the table grows.
+ */
+#define BUILTIN_SEED_ATTEMPTS 1024
+
+/**
+ * @brief The suffix of the descriptor a shared object exports for each
+ * builtin, as in `kv_get_builtin` for `kv-get`.
+ */
+#define BUILTIN_SYMBOL_SUFFIX "_builtin"
+
+/**
+ * @brief A perfect hash table over the registered builtins.
+ *
+ * `builtins` holds the compiled-in builtins followed by the loaded ones. The
+ * seed is searched again whenever the set changes so that no two names share
+ * a slot; a lookup is then a single hash and a single comparison.
+ */
+typedef struct s_builtin_registry {
+  t_builtin *builtins;
+  size_t count;
+  const t_builtin **slots;
+  size_t mask;
+  unsigned seed;
+} t_builtin_registry;
+
+int builtin_cd(const char **argv, t_environment *environment, t_io_context io);
+int builtin_echo(const char **argv, t_environment *environment,
+                 t_io_context io);
+int builtin_env(const char **argv, t_environment *environment,
+                t_io_context io);
+int builtin_enable(const char **argv, t_environment *environment,
+                   t_io_context io);
+int builtin_exit(const char **argv, t_environment *environment,
+                 t_io_context io);
+int builtin_export(const char **argv, t_environment *environment,
+                   t_io_context io);
+int builtin_hash(const char **argv, t_environment *environment,
+                 t_io_context io);
+int builtin_jobs(const char **argv, t_environment *environment,
+                 t_io_context io);
+int builtin_parallel(const char **argv, t_environment *environment,
+                     t_io_context io);
+int builtin_parsecache(const char **argv, t_environment *environment,
+                       t_io_context io);
+int builtin_pwd(const char **argv, t_environment *environment,
+                t_io_context io);
+int builtin_source(const char **argv, t_environment *environment,
+                   t_io_context io);
+int builtin_unset(const char **argv, t_environment *environment,
+                  t_io_context io);
+int builtin_wait(const char **argv, t_environment *environment,
+                 t_io_context io);
+
+t_builtin_registry *builtin_registry(void);
+void builtin_registry_build(t_builtin_registry *registry);
+void builtin_register(const t_builtin *builtin);
+unsigned builtin_hash_name(const char *name, unsigned seed);
+
+/**
+ * @brief Marks where `parallel` substitutes each argument; the argument is
+ * appended when the command has no placeholder.
+ */
+#define PARALLEL_PLACEHOLDER "{}"
+#define PARALLEL_ARGUMENTS ":::"
+#define PARALLEL_STATUS_ERROR 255
+#define PARALLEL_STATUS_MAX_FAILED 101
+
+/**
+ * @brief With ordered output, how many jobs per slot may be started ahead of
+ * the first one not printed yet; each of them holds a memory file.
+ */
+#define PARALLEL_ORDER_WINDOW 2
+
+/**
+ * @brief One command run by `parallel`.
+ *
+ * With ordered output, `out_fd` is a memory file holding what the command
+ * wrote until every earlier command has been printed; it is -1 otherwise.
+ */
+typedef struct s_parallel_job {
+  const char *argument;
+  pid_t pid;
+  int out_fd;
+  int status;
+  bool done;
+} t_parallel_job;
+
+typedef struct s_parallel {
+  size_t max_running;
+  bool keep_order;
+  bool verbose;
+  const char *argument_file;
+  const char **template;
+  size_t template_count;
+  const char *path;
+  t_parallel_job *jobs;
+  size_t count;
+  char *input;
+  t_environment *environment;
+  t_io_context io;
+} t_parallel;
+
+/**
+ * @brief Flushes the output of the builtin `name`, reporting a failed write.
+ *
+ * @return The exit status the builtin should return.
+ */
+int builtin_flush(t_writer *writer, const char *name);
+
+#endif
@@ -0,0 +1,24 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "job/job.h"
+#include "minishell.h"
+
+int builtin_jobs(const char **argv, t_environment *environment,
+                 t_io_context io) {
+  (void)environment;
+
+  bool with_pids = argv[1] && strcmp(argv[1], "-l") == 0;
+
+  if (job_print(io.out_fd, with_pids) == -1) {
+    if (errno != EPIPE) {
+      fprintf(stderr, "%s: jobs: write error: %s\n", MINISHELL_NAME,
+              strerror(errno));
+    }
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
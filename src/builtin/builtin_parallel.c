@@ -0,0 +1,370 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "builtin_internal.h"
+#include "ft_stdlib.h"
+#include "minishell.h"
+#include "reaper/reaper.h"
+
+#define PARALLEL_USAGE \
+  "parallel [-j jobs] [-k] [-v] [-a file] command [arg...] [::: arg...]"
+
+/**
+ * @brief Reads the options and splits the command template from the
+ * arguments given after `:::`.
+ *
+ * @return false on a usage error.
+ */
+static bool builtin_parallel_options(t_parallel *parallel, const char **argv) {
+  size_t i = 1;
+
+  for (; argv[i] && argv[i][0] == '-'; ++i) {
+    if (strcmp(argv[i], "--") == 0) {
+      ++i;
+      break;
+    } else if (strcmp(argv[i], "-k") == 0) {
+      parallel->keep_order = true;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      parallel->verbose = true;
+    } else if (strcmp(argv[i], "-a") == 0 && argv[i + 1]) {
+      parallel->argument_file = argv[++i];
+    } else if (strcmp(argv[i], "-j") == 0 && argv[i + 1]) {
+      char *end;
+      long max_running = strtol(argv[++i], &end, 10);
+      if (*end || max_running < 1) return false;
+      parallel->max_running = (size_t)max_running;
+    } else {
+      return false;
+    }
+  }
+
+  parallel->template = argv + i;
+  while (argv[i] && strcmp(argv[i], PARALLEL_ARGUMENTS) != 0) ++i;
+  parallel->template_count = argv + i - parallel->template;
+  if (parallel->template_count == 0) return false;
+
+  if (!argv[i]) return true;
+  if (parallel->argument_file) return false;
+
+  // Arguments given on the command line are used in place
+  parallel->count = 0;
+  while (argv[i + 1 + parallel->count]) ++parallel->count;
+  parallel->jobs =
+      ft_expect(calloc(parallel->count + 1, sizeof(t_parallel_job)), __func__);
+  for (size_t k = 0; k < parallel->count; ++k) {
+    parallel->jobs[k].argument = argv[i + 1 + k];
+  }
+  return true;
+}
+
+/**
+ * @brief Reads one argument per line from `fd` into `input`.
+ */
+static bool builtin_parallel_read(t_parallel *parallel, int fd) {
+  size_t length = 0;
+  size_t capacity = 4096;
+  ssize_t bytes;
+
+  parallel->input = ft_expect(malloc(capacity), __func__);
+  while ((bytes = read(fd, parallel->input + length, capacity - length)) != 0) {
+    if (bytes == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    length += bytes;
+    if (length == capacity) {
+      capacity *= 2;
+      parallel->input = ft_expect(realloc(parallel->input, capacity), __func__);
+    }
+  }
+  parallel->input[length] = '\0';
+
+  // Lines are split in place; a final line needs no newline
+  parallel->count = 0;
+  for (size_t i = 0; i < length; ++i) {
+    parallel->count += parallel->input[i] == '\n';
+  }
+  parallel->count += length > 0 && parallel->input[length - 1] != '\n';
+
+  parallel->jobs =
+      ft_expect(calloc(parallel->count + 1, sizeof(t_parallel_job)), __func__);
+  char *line = parallel->input;
+  for (size_t k = 0; k < parallel->count; ++k) {
+    char *newline = strchr(line, '\n');
+    parallel->jobs[k].argument = line;
+    if (!newline) break;
+    *newline = '\0';
+    line = newline + 1;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns `word` with every placeholder replaced by `argument`.
+ *
+ * @return A new string, or NULL if `word` has no placeholder.
+ */
+static char *builtin_parallel_substitute(const char *word,
+                                         const char *argument) {
+  const size_t placeholder_length = sizeof(PARALLEL_PLACEHOLDER) - 1;
+  size_t argument_length = strlen(argument);
+  size_t count = 0;
+
+  for (const char *s = word; (s = strstr(s, PARALLEL_PLACEHOLDER));
+       s += placeholder_length) {
+    ++count;
+  }
+  if (count == 0) return NULL;
+
+  char *result = ft_expect(
+      malloc(strlen(word) + count * argument_length + 1), __func__);
+  char *out = result;
+  const char *placeholder;
+  while ((placeholder = strstr(word, PARALLEL_PLACEHOLDER))) {
+    memcpy(out, word, placeholder - word);
+    out += placeholder - word;
+    memcpy(out, argument, argument_length);
+    out += argument_length;
+    word = placeholder + placeholder_length;
+  }
+  strcpy(out, word);
+  return result;
+}
+
+/**
+ * @brief Starts the command of `job`, recording its status at once if it
+ * could not be started.
+ */
+static void builtin_parallel_start(t_parallel *parallel, t_parallel_job *job) {
+  char *argv[parallel->template_count + 2];
+  char *substituted[parallel->template_count];
+  bool has_placeholder = false;
+
+  for (size_t i = 0; i < parallel->template_count; ++i) {
+    substituted[i] =
+        builtin_parallel_substitute(parallel->template[i], job->argument);
+    has_placeholder |= substituted[i] != NULL;
+    argv[i] = substituted[i] ? substituted[i] : (char *)parallel->template[i];
+  }
+  argv[parallel->template_count] =
+      has_placeholder ? NULL : (char *)job->argument;
+  argv[parallel->template_count + 1] = NULL;
+
+  job->pid = -1;
+  job->out_fd = -1;
+  const char *path = parallel->path
+                         ? parallel->path
+                         : environment_command_path(parallel->environment,
+                                                    argv[0]);
+  t_io_context io = parallel->io;
+  if (!path) {
+    fprintf(stderr, "%s: command not found: %s\n", MINISHELL_NAME, argv[0]);
+    job->status = EVALUATOR_STATUS_NOT_FOUND;
+  } else if (parallel->keep_order &&
+             (job->out_fd = memfd_create("minishell-parallel",
+                                         MFD_CLOEXEC)) == -1) {
+    perror(MINISHELL_NAME);
+    job->status = EXIT_FAILURE;
+  } else {
+    if (job->out_fd != -1) io.out_fd = job->out_fd;
+    job->pid = evaluator_launch(
+        path, argv, environment_envp(parallel->environment), io);
+    if (job->pid == -1) {
+      fprintf(stderr, "%s: %s: %s\n", MINISHELL_NAME, argv[0],
+              strerror(errno));
+      job->status = errno == ENOENT ? EVALUATOR_STATUS_NOT_FOUND
+                                    : EVALUATOR_STATUS_NOT_EXECUTABLE;
+    }
+  }
+
+  job->done = job->pid == -1;
+  for (size_t i = 0; i < parallel->template_count; ++i) free(substituted[i]);
+}
+
+/**
+ * @brief Waits for the first of the running jobs to finish and records it.
+ *
+ * @param pids Room for a pid per running job.
+ */
+static void builtin_parallel_reap(t_parallel *parallel, size_t started,
+                                  pid_t *pids) {
+  size_t count = 0;
+  int wait_status;
+
+  for (size_t i = 0; i < started; ++i) {
+    if (!parallel->jobs[i].done) pids[count++] = parallel->jobs[i].pid;
+  }
+
+  pid_t pid = reaper_wait_any(pids, count, &wait_status);
+  for (size_t i = 0; i < started; ++i) {
+    t_parallel_job *job = &parallel->jobs[i];
+    if (!job->done && job->pid == pid) {
+      job->status = wait_status == -1 ? EXIT_FAILURE
+                                      : evaluator_status(wait_status);
+      job->done = true;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Prints the buffered output of `job` and releases it.
+ */
+static void builtin_parallel_print(t_parallel *parallel, t_parallel_job *job) {
+  char buffer[WRITER_BUFFER_SIZE * 4];
+  t_writer writer;
+  ssize_t bytes;
+
+  if (job->out_fd == -1) return;
+  writer_init(&writer, parallel->io.out_fd);
+  lseek(job->out_fd, 0, SEEK_SET);
+  while ((bytes = read(job->out_fd, buffer, sizeof(buffer))) > 0) {
+    writer_write(&writer, buffer, bytes);
+  }
+  writer_flush(&writer);
+  close(job->out_fd);
+  job->out_fd = -1;
+}
+
+/**
+ * @brief Reports the status of the commands on the standard error.
+ *
+ * @return The number of failed commands, capped as GNU parallel does.
+ */
+static int builtin_parallel_report(const t_parallel *parallel) {
+  size_t failed = 0;
+
+  for (size_t i = 0; i < parallel->count; ++i) {
+    const t_parallel_job *job = &parallel->jobs[i];
+    if (job->status != EXIT_SUCCESS) ++failed;
+    if (job->status != EXIT_SUCCESS || parallel->verbose) {
+      fprintf(stderr, "parallel: [%zu] exit %d: %s\n", i + 1, job->status,
+              job->argument);
+    }
+  }
+  if (parallel->verbose) {
+    fprintf(stderr, "parallel: %zu jobs, %zu failed\n", parallel->count,
+            failed);
+  }
+  return failed < PARALLEL_STATUS_MAX_FAILED ? (int)failed
+                                             : PARALLEL_STATUS_MAX_FAILED;
+}
+
+/**
+ * @brief Releases what `builtin_parallel` allocated or opened.
+ */
+static void builtin_parallel_free(t_parallel *parallel, t_io_context io) {
+  if (parallel->io.in_fd != io.in_fd && parallel->io.in_fd != -1) {
+    close(parallel->io.in_fd);
+  }
+  free(parallel->input);
+  free(parallel->jobs);
+}
+
+/**
+ * @brief Runs every job, keeping at most `max_running` of them alive; with
+ * ordered output, at most `PARALLEL_ORDER_WINDOW` times as many are started
+ * but not printed yet.
+ */
+static void builtin_parallel_run(t_parallel *parallel) {
+  size_t started = 0;
+  size_t running = 0;
+  size_t printed = 0;
+  size_t slots = parallel->max_running < parallel->count
+                     ? parallel->max_running
+                     : parallel->count;
+  pid_t *pids = ft_expect(malloc((slots + 1) * sizeof(pid_t)), __func__);
+
+  // Jobs done but not printed yet keep their output open, so a slow job
+  // holds back the start of later ones rather than let them pile up
+  size_t window = SIZE_MAX;
+  if (parallel->keep_order) {
+    window = parallel->max_running > SIZE_MAX / PARALLEL_ORDER_WINDOW
+                 ? SIZE_MAX
+                 : parallel->max_running * PARALLEL_ORDER_WINDOW;
+  }
+
+  while (printed < parallel->count) {
+    // Refill every free slot before waiting again
+    while (running < parallel->max_running && started < parallel->count &&
+           started - printed < window) {
+      builtin_parallel_start(parallel, &parallel->jobs[started]);
+      running += !parallel->jobs[started++].done;
+    }
+
+    if (running > 0) {
+      builtin_parallel_reap(parallel, started, pids);
+      running = 0;
+      for (size_t i = printed; i < started; ++i) {
+        running += !parallel->jobs[i].done;
+      }
+    }
+
+    // Output is released in order, as soon as every earlier job is done
+    while (printed < started && parallel->jobs[printed].done) {
+      builtin_parallel_print(parallel, &parallel->jobs[printed++]);
+    }
+  }
+  free(pids);
+}
+
+int builtin_parallel(const char **argv, t_environment *environment,
+                     t_io_context io) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  t_parallel parallel = {
+      .max_running = cpus > 0 ? (size_t)cpus : 1,
+      .environment = environment,
+      .io = io,
+  };
+
+  if (!builtin_parallel_options(&parallel, argv)) {
+    fprintf(stderr, "%s: parallel: usage: %s\n", MINISHELL_NAME,
+            PARALLEL_USAGE);
+    builtin_parallel_free(&parallel, io);
+    return PARALLEL_STATUS_ERROR;
+  }
+
+  // Without `:::`, the arguments come from a file or the standard input,
+  // which the commands then do not get
+  if (!parallel.jobs) {
+    int fd = io.in_fd;
+    if (parallel.argument_file) {
+      fd = open(parallel.argument_file, O_RDONLY | O_CLOEXEC);
+    }
+    bool loaded = fd != -1 && builtin_parallel_read(&parallel, fd);
+    if (parallel.argument_file && fd != -1) close(fd);
+    if (!loaded) {
+      perror(parallel.argument_file ? parallel.argument_file : "parallel");
+      builtin_parallel_free(&parallel, io);
+      return PARALLEL_STATUS_ERROR;
+    }
+    if (!parallel.argument_file) {
+      parallel.io.in_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+  }
+
+  // The command is looked up once for every job, unless its name varies
+  if (!strstr(parallel.template[0], PARALLEL_PLACEHOLDER)) {
+    parallel.path = environment_command_path(environment, parallel.template[0]);
+    if (!parallel.path) {
+      fprintf(stderr, "%s: command not found: %s\n", MINISHELL_NAME,
+              parallel.template[0]);
+      builtin_parallel_free(&parallel, io);
+      return EVALUATOR_STATUS_NOT_FOUND;
+    }
+  }
+
+  builtin_parallel_run(&parallel);
+  int status = builtin_parallel_report(&parallel);
+
+  builtin_parallel_free(&parallel, io);
+  return status;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+#include "parser/parser.h"
+
+static void builtin_parsecache_put(t_writer *writer, const char *name,
+                                   size_t value) {
+  char line[64];
+
+  snprintf(line, sizeof(line), "%s\t%zu\n", name, value);
+  writer_puts(writer, line);
+}
+
+/**
+ * @brief Prints the counters of the parse cache, one `name\tvalue` per line.
+ */
+static int builtin_parsecache_print(t_io_context io) {
+  t_parser_cache_stats stats = parser_cache_stats();
+  t_writer writer;
+
+  writer_init(&writer, io.out_fd);
+  builtin_parsecache_put(&writer, "hits", stats.hits);
+  builtin_parsecache_put(&writer, "misses", stats.misses);
+  builtin_parsecache_put(&writer, "evictions", stats.evictions);
+  builtin_parsecache_put(&writer, "entries", stats.entries);
+  builtin_parsecache_put(&writer, "size", stats.size);
+  builtin_parsecache_put(&writer, "capacity", stats.capacity);
+  return builtin_flush(&writer, "parsecache");
+}
+
+int builtin_parsecache(const char **argv, t_environment *environment,
+                       t_io_context io) {
+  (void)environment;
+  if (!argv[1]) return builtin_parsecache_print(io);
+
+  if (strcmp(argv[1], "-r") == 0 && !argv[2]) {
+    parser_cache_clear();
+    return EXIT_SUCCESS;
+  }
+
+  if (strcmp(argv[1], "-s") == 0 && argv[2] && !argv[3]) {
+    char *end;
+    long long capacity = strtoll(argv[2], &end, 10);
+    if (!*end && end != argv[2] && capacity >= 0) {
+      parser_cache_resize((size_t)capacity);
+      return EXIT_SUCCESS;
+    }
+  }
+
+  fprintf(stderr, "%s: parsecache: usage: parsecache [-r | -s bytes]\n",
+          MINISHELL_NAME);
+  return EXIT_FAILURE;
+}
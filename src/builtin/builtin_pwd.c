@@ -0,0 +1,26 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "builtin_internal.h"
+
+int builtin_pwd(const char **argv, t_environment *environment,
+                t_io_context io) {
+  (void)argv;
+  (void)environment;
+
+  t_writer writer;
+  char pwd[4096];
+
+  if (!getcwd(pwd, sizeof(pwd))) {
+    perror("pwd");
+    return EXIT_FAILURE;
+  }
+
+  writer_init(&writer, io.out_fd);
+  writer_puts(&writer, pwd);
+  writer_putc(&writer, '\n');
+  return builtin_flush(&writer, "pwd");
+}
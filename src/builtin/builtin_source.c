@@ -0,0 +1,48 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "builtin_internal.h"
+#include "minishell.h"
+#include "script/script.h"
+
+/**
+ * @brief Makes `fd` the descriptor `target` while the script runs.
+ *
+ * @return A copy of the former `target` to restore, or -1 if there is none
+ * to restore.
+ */
+static int builtin_source_redirect(int fd, int target) {
+  if (fd == target) return -1;
+
+  int saved = fcntl(target, F_DUPFD_CLOEXEC, 0);
+  dup2(fd, target);
+  return saved;
+}
+
+static void builtin_source_restore(int saved, int target) {
+  if (saved == -1) return;
+  dup2(saved, target);
+  close(saved);
+}
+
+int builtin_source(const char **argv, t_environment *environment,
+                   t_io_context io) {
+  if (!argv[1]) {
+    fprintf(stderr, "%s: %s: filename argument required\n", MINISHELL_NAME,
+            argv[0]);
+    return SCRIPT_STATUS_USAGE;
+  }
+
+  // The commands of the script use the standard streams, so the builtin's
+  // own descriptors take their place while it runs
+  int saved_in = builtin_source_redirect(io.in_fd, STDIN_FILENO);
+  int saved_out = builtin_source_redirect(io.out_fd, STDOUT_FILENO);
+  int status = script_run_file(argv[1], environment);
+  builtin_source_restore(saved_out, STDOUT_FILENO);
+  builtin_source_restore(saved_in, STDIN_FILENO);
+  return status;
+}
@@ -0,0 +1,13 @@
+#include <stdlib.h>
+
+#include "builtin_internal.h"
+
+int builtin_unset(const char **argv, t_environment *environment,
+                  t_io_context io) {
+  (void)io;
+
+  for (size_t i = 1; argv[i]; ++i) {
+    environment_unset(environment, argv[i]);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin_internal.h"
+#include "job/job.h"
+#include "minishell.h"
+
+/**
+ * @brief Resolves a `wait` operand: `%n` names job `n`, anything else a pid.
+ *
+ * @return The job, or NULL if the operand names none.
+ */
+static t_job *builtin_wait_operand(const char *operand) {
+  char *end;
+  long number = strtol(operand + (*operand == '%'), &end, 10);
+
+  if (*end || end == operand + (*operand == '%')) return NULL;
+  if (*operand == '%') return job_get((int)number);
+  return job_find((pid_t)number);
+}
+
+int builtin_wait(const char **argv, t_environment *environment,
+                 t_io_context io) {
+  (void)environment;
+  (void)io;
+
+  // Without operands every job is waited for, and the status is 0
+  if (!argv[1]) {
+    while (job_wait_next() != -1) {
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (strcmp(argv[1], "-n") == 0) {
+    int status = job_wait_next();
+    return status == -1 ? EVALUATOR_STATUS_NOT_FOUND : status;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (size_t i = 1; argv[i]; ++i) {
+    t_job *job = builtin_wait_operand(argv[i]);
+    if (!job) {
+      fprintf(stderr, "%s: wait: %s: no such job\n", MINISHELL_NAME,
+              argv[i]);
+      status = EVALUATOR_STATUS_NOT_FOUND;
+    } else {
+      status = job_wait(job);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,344 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "cache.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cache_internal.h"
+#include "ft_stdlib.h"
+#include "minishell.h"
+#include "token/token.h"
+
+bool cache_file(char *buffer, size_t size, const char *directory,
+                const char *path) {
+  uint64_t hash = 0xcbf29ce484222325u;
+
+  // FNV-1a; the full path is stored in the image and compared on load
+  for (const char *c = path; *c; ++c) {
+    hash = (hash ^ (unsigned char)*c) * 0x100000001b3u;
+  }
+
+  int length = snprintf(buffer, size, "%s/%016llx" CACHE_EXTENSION, directory,
+                        (unsigned long long)hash);
+  return length > 0 && (size_t)length < size;
+}
+
+uint64_t cache_checksum(const char *data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325u;
+  uint64_t word;
+  size_t i = 0;
+
+  // FNV-1a over words rather than bytes, to keep up with the mapping
+  for (; i + sizeof(word) <= size; i += sizeof(word)) {
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3u;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ (unsigned char)data[i]) * 0x100000001b3u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Checks that the image was compiled by this shell from the script
+ * as it is now.
+ */
+static bool cache_is_valid(const t_cache *cache, const char *path,
+                           const struct stat *st) {
+  const t_cache_header *header = (const t_cache_header *)cache->data;
+
+  if (cache->size < sizeof(t_cache_header) + 1 ||
+      cache->data[cache->size - 1] != '\0' ||
+      memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->format != CACHE_FORMAT ||
+      strncmp(header->version, MINISHELL_VERSION, sizeof(header->version)) !=
+          0 ||
+      header->image_size != cache->size) {
+    return false;
+  }
+  if (header->mtime_sec != (int64_t)st->st_mtim.tv_sec ||
+      header->mtime_nsec != (int64_t)st->st_mtim.tv_nsec ||
+      header->size != (uint64_t)st->st_size) {
+    return false;
+  }
+  if (header->path == 0 || header->path >= cache->size ||
+      strcmp(cache->data + header->path, path) != 0) {
+    return false;
+  }
+  if (header->commands % CACHE_ALIGN != 0 ||
+      header->commands > cache->size ||
+      header->command_count >
+          (cache->size - header->commands) / sizeof(t_cache_command_entry)) {
+    return false;
+  }
+
+  // A damaged file is compiled again rather than run
+  return cache_checksum(cache->data + sizeof(t_cache_header),
+                        cache->size - sizeof(t_cache_header)) ==
+         header->checksum;
+}
+
+t_cache *cache_open(const char *directory, const char *path,
+                    const struct stat *st) {
+  char file[PATH_MAX];
+  struct stat image_st;
+
+  if (!cache_file(file, sizeof(file), directory, path)) return NULL;
+
+  int fd = open(file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NULL;
+  if (fstat(fd, &image_st) < 0 || !S_ISREG(image_st.st_mode) ||
+      (size_t)image_st.st_size < sizeof(t_cache_header)) {
+    close(fd);
+    return NULL;
+  }
+
+  void *data =
+      mmap(NULL, (size_t)image_st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  t_cache *cache = ft_expect(malloc(sizeof(t_cache)), __func__);
+  *cache = (t_cache){
+      .data = data,
+      .size = (size_t)image_st.st_size,
+  };
+  if (!cache_is_valid(cache, path, st)) {
+    close(fd);
+    cache_close(cache);
+    return NULL;
+  }
+
+  // Images are evicted by age, so one still in use is dated now and then
+  if (time(NULL) - image_st.st_mtim.tv_sec > CACHE_USE_INTERVAL) {
+    futimens(fd, NULL);
+  }
+  close(fd);
+
+  const t_cache_header *header = data;
+  cache->commands =
+      (const t_cache_command_entry *)(cache->data + header->commands);
+  cache->count = header->command_count;
+  return cache;
+}
+
+/**
+ * @brief Returns the `count` items of `size` bytes at `offset`, or NULL if
+ * they do not lie within the image.
+ */
+static const void *cache_at(const t_cache *cache, uint32_t offset,
+                            size_t count, size_t size) {
+  if (offset == 0 || offset % CACHE_ALIGN != 0 || offset > cache->size ||
+      count > (cache->size - offset) / size) {
+    return NULL;
+  }
+  return cache->data + offset;
+}
+
+/**
+ * @brief Returns the string at `offset`; the image ends with a NUL byte, so
+ * it is terminated.
+ */
+static const char *cache_string(const t_cache *cache, uint32_t offset) {
+  return offset > 0 && offset < cache->size ? cache->data + offset : NULL;
+}
+
+/**
+ * @brief Decodes the expansion at `offset` into `*expansion`.
+ *
+ * @return false if the image is corrupt.
+ */
+static bool cache_decode_expansion(const t_cache *cache, uint32_t offset,
+                                   t_arena *arena,
+                                   const t_word_expansion **expansion) {
+  *expansion = NULL;
+  if (offset == 0) return true;
+
+  const t_cache_expansion *source =
+      cache_at(cache, offset, 1, sizeof(t_cache_expansion));
+  if (!source) return false;
+  const t_cache_segment *segments =
+      cache_at(cache, source->segments, source->count, sizeof(*segments));
+  if (!segments) return false;
+
+  t_word_segment *decoded =
+      arena_alloc(arena, source->count * sizeof(t_word_segment));
+  for (size_t i = 0; i < source->count; ++i) {
+    decoded[i] = (t_word_segment){
+        .type = segments[i].type,
+        .text = cache_string(cache, segments[i].text),
+        .length = segments[i].length,
+    };
+    if (segments[i].text &&
+        (!decoded[i].text ||
+         segments[i].length >= cache->size - segments[i].text)) {
+      return false;
+    }
+  }
+
+  t_word_expansion *result = arena_alloc(arena, sizeof(t_word_expansion));
+  *result = (t_word_expansion){
+      .segments = decoded,
+      .count = source->count,
+      .quoted = source->quoted,
+      .glob = source->glob,
+  };
+  *expansion = result;
+  return true;
+}
+
+/**
+ * @brief Decodes the words and redirections of a simple command.
+ */
+static bool cache_decode_simple_command(const t_cache *cache,
+                                        const t_cache_node *node,
+                                        t_arena *arena, t_ast *ast) {
+  const t_cache_word *words =
+      node->count ? cache_at(cache, node->items, node->count, sizeof(*words))
+                  : NULL;
+  const t_cache_io_file *io_files =
+      node->io_file_count ? cache_at(cache, node->detail, node->io_file_count,
+                                     sizeof(*io_files))
+                          : NULL;
+  if ((node->count && !words) || (node->io_file_count && !io_files)) {
+    return false;
+  }
+
+  const char **argv = arena_alloc(arena, (node->count + 1) * sizeof(char *));
+  const t_word_expansion **expansions = NULL;
+  for (size_t i = 0; i < node->count; ++i) {
+    const t_word_expansion *expansion;
+    argv[i] = cache_string(cache, words[i].text);
+    if (!argv[i] ||
+        !cache_decode_expansion(cache, words[i].expansion, arena, &expansion)) {
+      return false;
+    }
+    if (expansion && !expansions) {
+      expansions = arena_calloc(arena, node->count * sizeof(void *));
+    }
+    if (expansions) expansions[i] = expansion;
+  }
+  argv[node->count] = NULL;
+
+  t_io_file *decoded =
+      arena_alloc(arena, node->io_file_count * sizeof(t_io_file));
+  for (size_t i = 0; i < node->io_file_count; ++i) {
+    if (io_files[i].op < TOKEN_LESS || io_files[i].op > TOKEN_DGREAT) {
+      return false;
+    }
+    decoded[i] = (t_io_file){
+        .op = token_operator(io_files[i].op),
+        .filename = cache_string(cache, io_files[i].filename),
+        .fd = -1,
+        .quoted = io_files[i].quoted != 0,
+    };
+    if (!decoded[i].filename ||
+        !cache_decode_expansion(cache, io_files[i].expansion, arena,
+                                &decoded[i].expansion)) {
+      return false;
+    }
+  }
+
+  ast->simple_command.argv = argv;
+  ast->simple_command.argc = node->count;
+  ast->simple_command.expansions = expansions;
+  ast->simple_command.io_files = decoded;
+  ast->simple_command.io_file_count = node->io_file_count;
+  return true;
+}
+
+/**
+ * @brief Decodes the tree rooted at `offset` into `arena`.
+ *
+ * @return The tree, or NULL if the image is corrupt.
+ */
+static t_ast *cache_decode(const t_cache *cache, uint32_t offset,
+                           t_arena *arena, size_t depth) {
+  const t_cache_node *node = cache_at(cache, offset, 1, sizeof(*node));
+  if (!node || depth > CACHE_MAX_DEPTH || node->type > AST_SIMPLE_COMMAND) {
+    return NULL;
+  }
+
+  t_ast *ast = ast_new(arena, (t_ast){.type = node->type});
+  if (node->type == AST_SIMPLE_COMMAND) {
+    return cache_decode_simple_command(cache, node, arena, ast) ? ast : NULL;
+  }
+
+  const uint32_t *items =
+      cache_at(cache, node->items, node->count, sizeof(uint32_t));
+  if (!items || node->count == 0) return NULL;
+  t_ast **children = arena_alloc(arena, node->count * sizeof(t_ast *));
+  for (size_t i = 0; i < node->count; ++i) {
+    children[i] = cache_decode(cache, items[i], arena, depth + 1);
+    if (!children[i]) return NULL;
+  }
+
+  switch (node->type) {
+    case AST_LIST:
+      ast->list.children = children;
+      ast->list.count = node->count;
+      break;
+    case AST_AND_OR: {
+      const uint32_t *ops =
+          cache_at(cache, node->detail, node->count, sizeof(uint32_t));
+      if (!ops) return NULL;
+      ast->and_or.ops = arena_alloc(arena, node->count * sizeof(t_token *));
+      ast->and_or.ops[0] = NULL;
+      for (size_t i = 1; i < node->count; ++i) {
+        if (ops[i] != TOKEN_AND_IF && ops[i] != TOKEN_OR_IF) return NULL;
+        ast->and_or.ops[i] = token_operator(ops[i]);
+      }
+      ast->and_or.children = children;
+      ast->and_or.count = node->count;
+      break;
+    }
+    case AST_PIPE_SEQUENCE:
+      if (node->detail > AST_TIMING_JSON) return NULL;
+      ast->pipe_sequence.children = children;
+      ast->pipe_sequence.count = node->count;
+      ast->pipe_sequence.timing = node->detail;
+      break;
+    case AST_SUBSHELL:
+      ast->subshell.list = children[0];
+      break;
+    case AST_BACKGROUND:
+      ast->background.command = children[0];
+      break;
+    case AST_SIMPLE_COMMAND:
+      break;
+  }
+  return ast;
+}
+
+bool cache_next(t_cache *cache, t_arena *arena, t_cache_command *command) {
+  if (cache->next >= cache->count) return false;
+
+  const t_cache_command_entry *entry = &cache->commands[cache->next++];
+  command->ast = cache_decode(cache, entry->ast, arena, 0);
+  command->bodies = cache->data + entry->bodies;
+  command->bodies_length = entry->bodies_length;
+  if (!command->ast || entry->bodies > cache->size ||
+      entry->bodies_length > cache->size - entry->bodies) {
+    fprintf(stderr, MINISHELL_NAME ": compiled script is corrupt\n");
+    cache->failed = true;
+    cache->next = cache->count;
+    return false;
+  }
+  return true;
+}
+
+bool cache_failed(const t_cache *cache) { return cache->failed; }
+
+void cache_close(t_cache *cache) {
+  munmap((void *)cache->data, cache->size);
+  free(cache);
+}
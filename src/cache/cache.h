@@ -0,0 +1,93 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "arena/arena.h"
+#include "ast/ast.h"
+
+/**
+ * @brief A compiled script: the trees of its complete commands, serialized
+ * with offsets instead of pointers so the image is used as mapped.
+ */
+typedef struct s_cache t_cache;
+
+/**
+ * @brief Collects the complete commands of a script being compiled, as they
+ * are run.
+ */
+typedef struct s_cache_writer t_cache_writer;
+
+/**
+ * @brief One complete command of a compiled script.
+ *
+ * `bodies` is the script text that followed the command, holding the
+ * bodies of its here-documents; it is not NUL-terminated.
+ */
+typedef struct s_cache_command {
+  t_ast *ast;
+  const char *bodies;
+  size_t bodies_length;
+} t_cache_command;
+
+/**
+ * @brief Maps the compiled form of the script at the absolute `path` from
+ * `directory`.
+ *
+ * The image is keyed by the script's path, modification time and size, and
+ * by the shell version; any mismatch makes it stale, as does a checksum
+ * that does not match its contents.
+ *
+ * @return The image, or NULL if there is no valid one.
+ */
+t_cache *cache_open(const char *directory, const char *path,
+                    const struct stat *st);
+
+/**
+ * @brief Decodes the next complete command into `arena`.
+ *
+ * Words and filenames point into the image, so only the tree is built.
+ *
+ * @return false after the last command, or if the image turned out to be
+ * corrupt.
+ */
+bool cache_next(t_cache *cache, t_arena *arena, t_cache_command *command);
+
+/**
+ * @brief Whether the commands ran out early because the image turned out to
+ * be corrupt.
+ */
+bool cache_failed(const t_cache *cache);
+
+void cache_close(t_cache *cache);
+
+t_cache_writer *cache_writer_new(void);
+
+/**
+ * @brief Serializes the next complete command of the script.
+ *
+ * @return false if the command nests too deeply to be read back; the image
+ * is then unusable and must be discarded.
+ */
+bool cache_writer_add(t_cache_writer *writer, const t_ast *ast,
+                      const char *bodies, size_t bodies_length);
+
+/**
+ * @brief Finishes the image of every command of the script, stores it in
+ * `directory` and frees `writer`.
+ *
+ * The file is replaced atomically; failures to store it are ignored. The
+ * directory keeps a bounded number of images, and storing one evicts the
+ * least recently used past it.
+ */
+void cache_writer_finish(t_cache_writer *writer, const char *directory,
+                         const char *path, const struct stat *st);
+
+/**
+ * @brief Frees `writer` and the image it holds, without storing it.
+ */
+void cache_writer_discard(t_cache_writer *writer);
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef CACHE_INTERNAL_H
+#define CACHE_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cache.h"
+
+#define CACHE_MAGIC "MSHCACHE"
+
+/**
+ * @brief Version of the image layout, bumped whenever it changes.
+ */
+#define CACHE_FORMAT 3
+
+#define CACHE_EXTENSION ".msc"
+
+/**
+ * @brief Room for the name of an image: a 64-bit hash in hexadecimal and
+ * the extension.
+ */
+#define CACHE_NAME_SIZE 24
+
+/**
+ * @brief Nesting depth past which a tree is not compiled, and an image is
+ * taken as corrupt.
+ */
+#define CACHE_MAX_DEPTH 1024
+
+/**
+ * @brief Number of images a directory keeps; storing one more removes the
+ * least recently used.
+ */
+#define CACHE_MAX_IMAGES 256
+
+/**
+ * @brief Age in seconds past which an image that is used is marked used
+ * again, and a temporary file left by an interrupted store is removed.
+ */
+#define CACHE_USE_INTERVAL (24 * 60 * 60)
+
+/**
+ * @brief Everything in an image is aligned to this, so it is read in place.
+ */
+#define CACHE_ALIGN 8
+
+/**
+ * @brief Start of an image.
+ *
+ * Every other field of the image is an offset from its start, with 0 for
+ * none. The image ends with a NUL byte, so any string in it is terminated.
+ * `checksum` covers everything after the header.
+ */
+typedef struct s_cache_header {
+  char magic[8];
+  char version[16];
+  uint32_t format;
+  uint32_t path;
+  uint32_t commands;
+  uint32_t command_count;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t size;
+  uint64_t image_size;
+  uint64_t checksum;
+} t_cache_header;
+
+typedef struct s_cache_command_entry {
+  uint32_t ast;
+  uint32_t bodies;
+  uint32_t bodies_length;
+} t_cache_command_entry;
+
+/**
+ * @brief A node of the tree, mirroring `t_ast`.
+ *
+ * `items` holds the offsets of the `count` children, or the `count` words
+ * of a simple command. `detail` is the operator types of an and-or chain,
+ * the timing of a pipe sequence or the redirections of a simple command.
+ */
+typedef struct s_cache_node {
+  uint32_t type;
+  uint32_t count;
+  uint32_t items;
+  uint32_t detail;
+  uint32_t io_file_count;
+} t_cache_node;
+
+typedef struct s_cache_word {
+  uint32_t text;
+  uint32_t expansion;
+} t_cache_word;
+
+typedef struct s_cache_io_file {
+  uint32_t op;
+  uint32_t filename;
+  uint32_t expansion;
+  uint32_t quoted;
+} t_cache_io_file;
+
+typedef struct s_cache_expansion {
+  uint32_t segments;
+  uint32_t count;
+  uint32_t quoted;
+  uint32_t glob;
+} t_cache_expansion;
+
+typedef struct s_cache_segment {
+  uint32_t type;
+  uint32_t text;
+  uint32_t length;
+} t_cache_segment;
+
+/**
+ * @brief An image, mapped from its file.
+ */
+struct s_cache {
+  const char *data;
+  size_t size;
+  const t_cache_command_entry *commands;
+  size_t count;
+  size_t next;
+  bool failed;
+};
+
+struct s_cache_writer {
+  char *data;
+  size_t size;
+  size_t capacity;
+  t_cache_command_entry *commands;
+  size_t count;
+  size_t commands_capacity;
+  bool too_deep;
+};
+
+/**
+ * @brief Builds the path of the image of `path` in `directory`.
+ *
+ * @return false if it does not fit in `size` bytes.
+ */
+bool cache_file(char *buffer, size_t size, const char *directory,
+                const char *path);
+
+/**
+ * @brief Hashes `size` bytes of an image, a word at a time.
+ */
+uint64_t cache_checksum(const char *data, size_t size);
+
+#endif
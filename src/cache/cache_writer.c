@@ -0,0 +1,376 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "cache_internal.h"
+#include "ft_stdlib.h"
+#include "minishell.h"
+
+t_cache_writer *cache_writer_new(void) {
+  t_cache_writer *writer =
+      ft_expect(calloc(1, sizeof(t_cache_writer)), __func__);
+
+  // The header is filled in last; reserving it keeps offset 0 for none
+  writer->capacity = 4096;
+  writer->data = ft_expect(calloc(1, writer->capacity), __func__);
+  writer->size = sizeof(t_cache_header);
+  return writer;
+}
+
+/**
+ * @brief Appends `size` bytes, zeroed when `data` is NULL, at the next
+ * aligned offset.
+ *
+ * @return Their offset.
+ */
+static uint32_t cache_emit(t_cache_writer *writer, const void *data,
+                           size_t size) {
+  size_t offset = (writer->size + CACHE_ALIGN - 1) / CACHE_ALIGN * CACHE_ALIGN;
+
+  if (offset + size > writer->capacity) {
+    size_t capacity = writer->capacity;
+    while (offset + size > capacity) capacity *= 2;
+    writer->data = ft_expect(realloc(writer->data, capacity), __func__);
+    writer->capacity = capacity;
+  }
+  memset(writer->data + writer->size, 0, offset - writer->size);
+  if (data) {
+    memcpy(writer->data + offset, data, size);
+  } else {
+    memset(writer->data + offset, 0, size);
+  }
+  writer->size = offset + size;
+  return (uint32_t)offset;
+}
+
+/**
+ * @brief Appends `length` bytes of text and a NUL byte.
+ */
+static uint32_t cache_emit_text(t_cache_writer *writer, const char *text,
+                                size_t length) {
+  uint32_t offset = cache_emit(writer, NULL, length + 1);
+
+  memcpy(writer->data + offset, text, length);
+  return offset;
+}
+
+static uint32_t cache_emit_expansion(t_cache_writer *writer,
+                                     const t_word_expansion *expansion) {
+  if (!expansion) return 0;
+
+  t_cache_expansion encoded = {
+      .segments = cache_emit(writer, NULL,
+                             expansion->count * sizeof(t_cache_segment)),
+      .count = (uint32_t)expansion->count,
+      .quoted = expansion->quoted,
+      .glob = expansion->glob,
+  };
+  for (size_t i = 0; i < expansion->count; ++i) {
+    const t_word_segment *segment = &expansion->segments[i];
+    t_cache_segment encoded_segment = {
+        .type = segment->type,
+        .text = segment->text
+                    ? cache_emit_text(writer, segment->text, segment->length)
+                    : 0,
+        .length = (uint32_t)segment->length,
+    };
+    // Emitting the text may have moved the buffer
+    memcpy(writer->data + encoded.segments + i * sizeof(t_cache_segment),
+           &encoded_segment, sizeof(encoded_segment));
+  }
+  return cache_emit(writer, &encoded, sizeof(encoded));
+}
+
+static void cache_emit_simple_command(t_cache_writer *writer,
+                                      const t_ast *ast, t_cache_node *node) {
+  size_t argc = ast->simple_command.argc;
+  size_t io_file_count = ast->simple_command.io_file_count;
+
+  node->count = (uint32_t)argc;
+  node->io_file_count = (uint32_t)io_file_count;
+  node->items = argc ? cache_emit(writer, NULL, argc * sizeof(t_cache_word))
+                     : 0;
+  for (size_t i = 0; i < argc; ++i) {
+    const char *word = ast->simple_command.argv[i];
+    const t_word_expansion *expansion =
+        ast->simple_command.expansions ? ast->simple_command.expansions[i]
+                                       : NULL;
+    t_cache_word encoded = {
+        .text = cache_emit_text(writer, word, strlen(word)),
+        .expansion = cache_emit_expansion(writer, expansion),
+    };
+    memcpy(writer->data + node->items + i * sizeof(t_cache_word), &encoded,
+           sizeof(encoded));
+  }
+
+  node->detail =
+      io_file_count
+          ? cache_emit(writer, NULL, io_file_count * sizeof(t_cache_io_file))
+          : 0;
+  for (size_t i = 0; i < io_file_count; ++i) {
+    const t_io_file *io_file = &ast->simple_command.io_files[i];
+    t_cache_io_file encoded = {
+        .op = io_file->op->type,
+        .filename =
+            cache_emit_text(writer, io_file->filename,
+                            strlen(io_file->filename)),
+        .expansion = cache_emit_expansion(writer, io_file->expansion),
+        .quoted = io_file->quoted,
+    };
+    memcpy(writer->data + node->detail + i * sizeof(t_cache_io_file),
+           &encoded, sizeof(encoded));
+  }
+}
+
+/**
+ * @brief Serializes the tree rooted at `ast`, `depth` levels down, children
+ * first.
+ *
+ * A tree nesting deeper than a reader accepts is cut short, and marks the
+ * writer `too_deep`.
+ *
+ * @return The offset of its node.
+ */
+static uint32_t cache_emit_ast(t_cache_writer *writer, const t_ast *ast,
+                               size_t depth) {
+  t_cache_node node = {.type = ast->type};
+
+  if (depth > CACHE_MAX_DEPTH) {
+    writer->too_deep = true;
+    return 0;
+  }
+  t_ast *const *children = NULL;
+  const t_token **ops = NULL;
+
+  switch (ast->type) {
+    case AST_LIST:
+      children = ast->list.children;
+      node.count = (uint32_t)ast->list.count;
+      break;
+    case AST_AND_OR:
+      children = ast->and_or.children;
+      ops = ast->and_or.ops;
+      node.count = (uint32_t)ast->and_or.count;
+      break;
+    case AST_PIPE_SEQUENCE:
+      children = ast->pipe_sequence.children;
+      node.count = (uint32_t)ast->pipe_sequence.count;
+      node.detail = ast->pipe_sequence.timing;
+      break;
+    case AST_SUBSHELL:
+      children = &ast->subshell.list;
+      node.count = 1;
+      break;
+    case AST_BACKGROUND:
+      children = &ast->background.command;
+      node.count = 1;
+      break;
+    case AST_SIMPLE_COMMAND:
+      cache_emit_simple_command(writer, ast, &node);
+      return cache_emit(writer, &node, sizeof(node));
+  }
+
+  uint32_t *items =
+      ft_expect(malloc(node.count * sizeof(uint32_t)), __func__);
+  for (size_t i = 0; i < node.count; ++i) {
+    items[i] = cache_emit_ast(writer, children[i], depth + 1);
+  }
+  node.items = cache_emit(writer, items, node.count * sizeof(uint32_t));
+  if (ops) {
+    for (size_t i = 0; i < node.count; ++i) {
+      items[i] = ops[i] ? ops[i]->type : 0;
+    }
+    node.detail = cache_emit(writer, items, node.count * sizeof(uint32_t));
+  }
+  free(items);
+  return cache_emit(writer, &node, sizeof(node));
+}
+
+bool cache_writer_add(t_cache_writer *writer, const t_ast *ast,
+                      const char *bodies, size_t bodies_length) {
+  t_cache_command_entry entry = {
+      .ast = cache_emit_ast(writer, ast, 0),
+      .bodies = bodies_length ? cache_emit_text(writer, bodies, bodies_length)
+                              : 0,
+      .bodies_length = (uint32_t)bodies_length,
+  };
+
+  if (writer->count == writer->commands_capacity) {
+    writer->commands_capacity =
+        writer->commands_capacity ? writer->commands_capacity * 2 : 64;
+    writer->commands = ft_expect(
+        realloc(writer->commands,
+                writer->commands_capacity * sizeof(t_cache_command_entry)),
+        __func__);
+  }
+  writer->commands[writer->count++] = entry;
+  return !writer->too_deep;
+}
+
+/**
+ * @brief Creates `directory` and its missing parents, private to the user.
+ */
+static bool cache_make_directory(const char *directory) {
+  char path[PATH_MAX];
+  size_t length = strlen(directory);
+
+  if (length >= sizeof(path)) return false;
+  memcpy(path, directory, length + 1);
+  for (char *slash = path + 1; (slash = strchr(slash, '/')); ++slash) {
+    *slash = '\0';
+    if (mkdir(path, 0700) < 0 && errno != EEXIST) return false;
+    *slash = '/';
+  }
+  return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+/**
+ * @brief An image found in the cache directory.
+ */
+typedef struct s_cache_image {
+  char name[CACHE_NAME_SIZE];
+  time_t used;
+} t_cache_image;
+
+static int cache_image_compare(const void *a, const void *b) {
+  const t_cache_image *left = a;
+  const t_cache_image *right = b;
+
+  return (left->used > right->used) - (left->used < right->used);
+}
+
+/**
+ * @brief Checks whether `name` is that of an image, or of a temporary file
+ * an image was being written to.
+ */
+static bool cache_is_image(const char *name, bool *temporary) {
+  const char *extension = strstr(name, CACHE_EXTENSION);
+
+  if (!extension) return false;
+  extension += sizeof(CACHE_EXTENSION) - 1;
+  *temporary = *extension == '.';
+  return *extension == '\0' || *temporary;
+}
+
+/**
+ * @brief Removes the least recently used images past `CACHE_MAX_IMAGES`,
+ * and the temporary files of stores that never finished, so the directory
+ * does not grow with every script ever run.
+ */
+static void cache_prune(const char *directory) {
+  DIR *dir = opendir(directory);
+  t_cache_image *images = NULL;
+  size_t count = 0;
+  size_t capacity = 0;
+  struct dirent *entry;
+  struct stat st;
+  bool temporary;
+
+  if (!dir) return;
+  while ((entry = readdir(dir))) {
+    if (!cache_is_image(entry->d_name, &temporary) ||
+        fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0) {
+      continue;
+    }
+    if (temporary) {
+      if (time(NULL) - st.st_mtim.tv_sec > CACHE_USE_INTERVAL) {
+        unlinkat(dirfd(dir), entry->d_name, 0);
+      }
+      continue;
+    }
+    if (strlen(entry->d_name) >= CACHE_NAME_SIZE) continue;
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : CACHE_MAX_IMAGES + 1;
+      images = ft_expect(realloc(images, capacity * sizeof(t_cache_image)),
+                         __func__);
+    }
+    strcpy(images[count].name, entry->d_name);
+    images[count++].used = st.st_mtim.tv_sec;
+  }
+
+  if (count > CACHE_MAX_IMAGES) {
+    qsort(images, count, sizeof(t_cache_image), cache_image_compare);
+    for (size_t i = 0; i < count - CACHE_MAX_IMAGES; ++i) {
+      unlinkat(dirfd(dir), images[i].name, 0);
+    }
+  }
+  closedir(dir);
+  free(images);
+}
+
+/**
+ * @brief Writes the image to a temporary file, then renames it over the old
+ * one, so a concurrent reader never sees a partial image.
+ */
+static void cache_store(const t_cache_writer *writer, const char *directory,
+                        const char *path) {
+  char file[PATH_MAX];
+  char temporary[PATH_MAX + 8];
+
+  if (!cache_make_directory(directory) ||
+      !cache_file(file, sizeof(file), directory, path)) {
+    return;
+  }
+  snprintf(temporary, sizeof(temporary), "%s.XXXXXX", file);
+
+  int fd = mkstemp(temporary);
+  if (fd < 0) return;
+
+  size_t written = 0;
+  while (written < writer->size) {
+    ssize_t length =
+        write(fd, writer->data + written, writer->size - written);
+    if (length < 0 && errno == EINTR) continue;
+    if (length <= 0) break;
+    written += (size_t)length;
+  }
+  if (close(fd) < 0 || written < writer->size ||
+      rename(temporary, file) < 0) {
+    unlink(temporary);
+    return;
+  }
+  cache_prune(directory);
+}
+
+void cache_writer_finish(t_cache_writer *writer, const char *directory,
+                         const char *path, const struct stat *st) {
+  t_cache_header header = {
+      .magic = CACHE_MAGIC,
+      .version = MINISHELL_VERSION,
+      .format = CACHE_FORMAT,
+      .path = cache_emit_text(writer, path, strlen(path)),
+      .commands =
+          cache_emit(writer, writer->commands,
+                     writer->count * sizeof(t_cache_command_entry)),
+      .command_count = (uint32_t)writer->count,
+      .mtime_sec = st->st_mtim.tv_sec,
+      .mtime_nsec = st->st_mtim.tv_nsec,
+      .size = (uint64_t)st->st_size,
+  };
+
+  // The image ends with a NUL byte, which terminates any string in it
+  cache_emit(writer, NULL, 1);
+  header.image_size = writer->size;
+  header.checksum = cache_checksum(writer->data + sizeof(header),
+                                   writer->size - sizeof(header));
+  memcpy(writer->data, &header, sizeof(header));
+
+  cache_store(writer, directory, path);
+  cache_writer_discard(writer);
+}
+
+void cache_writer_discard(t_cache_writer *writer) {
+  free(writer->data);
+  free(writer->commands);
+  free(writer);
+}
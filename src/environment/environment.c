@@ -1,14 +1,30 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "environment.h"
 
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "ft_ansi.h"
 #include "ft_hashmap.h"
 #include "ft_stdlib.h"
 #include "ft_string.h"
 
-t_hashmap *environment_new(const char **variables) {
-  t_hashmap *environment = ft_expect(ft_hshnew(NULL), __func__);
+t_environment *environment_new(const char **variables) {
+  t_environment *environment =
+      ft_expect(malloc(sizeof(t_environment)), __func__);
+  *environment = (t_environment){
+      .variables = ft_expect(ft_hshnew(NULL), __func__),
+      .envp = NULL,
+      .envp_capacity = 0,
+      .envp_dirty = true,
+      .commands = ft_expect(ft_hshnew(NULL), __func__),
+      .status = 0,
+      .shell_pid = getpid(),
+  };
   for (size_t i = 0; variables[i] != NULL; ++i) {
     environment_set(environment, variables[i]);
   }
@@ -16,45 +32,98 @@ t_hashmap *environment_new(const char **variables) {
   return environment;
 }
 
-void environment_free(t_hashmap *environment) {
-  t_hashmap_iterator it = ft_hshbegin(environment);
+void environment_free(t_environment *environment) {
+  t_hashmap_iterator it = ft_hshbegin(environment->variables);
   while (ft_hshnext(&it)) {
     environment_unset(environment, it.key);
   }
-  ft_hshfree(environment);
+  ft_hshfree(environment->variables);
+  free(environment->envp);
+  environment_commands_reset(environment);
+  ft_hshfree(environment->commands);
+  free(environment);
+}
+
+const char *environment_get(const t_environment *environment,
+                            const char *name) {
+  const char *entry = ft_hshget(environment->variables, name);
+  return entry ? entry + strlen(name) + 1 : NULL;
 }
 
-void environment_set(t_hashmap *environment, const char *str) {
+void environment_set(t_environment *environment, const char *str) {
   const char *equal_sign = ft_strchr(str, '=');
   t_string name;
-  t_string value = NULL;
+  t_string entry = NULL;
   if (equal_sign) {
     name = ft_expect(ft_stnnew_size(str, equal_sign - str), __func__);
-    value = ft_expect(ft_stnnew(equal_sign + 1), __func__);
+    entry = ft_expect(ft_stnnew(str), __func__);
   } else {
     name = ft_expect(ft_stnnew(str), __func__);
   }
 
   environment_unset(environment, name);
-  if (!ft_hshset(environment, name, value)) {
+  if (!ft_hshset(environment->variables, name, entry)) {
     ft_panic(__func__);
   }
+  environment->envp_dirty |= environment_is_exported(name);
+}
+
+void environment_unset(t_environment *environment, const char *name) {
+  if (strcmp(name, "PATH") == 0) {
+    environment_commands_reset(environment);
+  }
+  environment->envp_dirty |= environment_is_exported(name);
+  ft_hshdel2(environment->variables, name, ft_stnfree, ft_stnfree);
+}
+
+char **environment_envp(t_environment *environment) {
+  if (!environment->envp_dirty) return environment->envp;
+
+  // Collect the entries again; the strings themselves are shared, not copied
+  size_t count = 0;
+  t_hashmap_iterator it = ft_hshbegin(environment->variables);
+  while (ft_hshnext(&it)) {
+    if (it.value && environment_is_exported(it.key)) {
+      if (count + 1 >= environment->envp_capacity) {
+        environment->envp_capacity = environment->envp_capacity * 2 + 64;
+        environment->envp =
+            ft_expect(realloc(environment->envp, environment->envp_capacity *
+                                                     sizeof(char *)),
+                      __func__);
+      }
+      environment->envp[count++] = it.value;
+    }
+  }
+
+  if (!environment->envp) {
+    environment->envp_capacity = 1;
+    environment->envp = ft_expect(malloc(sizeof(char *)), __func__);
+  }
+  environment->envp[count] = NULL;
+  environment->envp_dirty = false;
+  return environment->envp;
 }
 
-void environment_unset(t_hashmap *environment, const char *name) {
-  ft_hshdel2(environment, name, ft_stnfree, ft_stnfree);
+bool environment_is_exported(const char *name) {
+  // Special parameters such as `?` are shell-internal
+  if (!(isalpha((unsigned char)*name) || *name == '_')) return false;
+  while (*++name) {
+    if (!(isalnum((unsigned char)*name) || *name == '_')) return false;
+  }
+  return true;
 }
 
-void environment_print(const t_hashmap *environment) {
+void environment_print(const t_environment *environment) {
   static const int indent_size = 2;
 
-  t_hashmap_iterator it = ft_hshbegin(environment);
+  t_hashmap_iterator it = ft_hshbegin(environment->variables);
   printf("<" ANSI_MAGENTA "environment" ANSI_RESET ">\n");
   while (ft_hshnext(&it)) {
     printf("%*s<" ANSI_MAGENTA "variable" ANSI_RESET " " ANSI_CYAN
            "name" ANSI_RESET "=" ANSI_YELLOW "\"%s\"" ANSI_RESET " " ANSI_CYAN
            "value" ANSI_RESET "=" ANSI_YELLOW "\"%s\"" ANSI_RESET " />\n",
-           indent_size, "", it.key, (char *)it.value);
+           indent_size, "", it.key,
+           it.value ? (char *)it.value + strlen(it.key) + 1 : "");
   }
   printf("</" ANSI_MAGENTA "environment" ANSI_RESET ">\n");
 }
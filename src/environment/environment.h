@@ -1,12 +1,66 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
 #include "ft_hashmap.h"
 
-t_hashmap *environment_new(const char **variables);
-void environment_free(t_hashmap *environment);
-void environment_set(t_hashmap *environment, const char *str);
-void environment_unset(t_hashmap *environment, const char *name);
-void environment_print(const t_hashmap *environment);
+/**
+ * @brief The shell variables and the state derived from them.
+ *
+ * `variables` maps each name to its `NAME=value` entry, or to NULL for a
+ * name declared without a value. `envp` points at the same entries, so it is
+ * handed to new processes as is; it is only re-collected, without copying any
+ * string, after a set or unset marked it dirty.
+ *
+ * `commands` caches command name lookups through `PATH`; it maps a name to
+ * its absolute path, or to an empty string when the search failed.
+ *
+ * `status` and `shell_pid` back the special parameters `$?` and `$$`; they
+ * are plain fields, so neither is ever stored in `variables`.
+ */
+typedef struct s_environment {
+  t_hashmap *variables;
+  char **envp;
+  size_t envp_capacity;
+  bool envp_dirty;
+  t_hashmap *commands;
+  int status;
+  pid_t shell_pid;
+} t_environment;
+
+t_environment *environment_new(const char **variables);
+void environment_free(t_environment *environment);
+const char *environment_get(const t_environment *environment,
+                            const char *name);
+void environment_set(t_environment *environment, const char *str);
+void environment_unset(t_environment *environment, const char *name);
+void environment_print(const t_environment *environment);
+
+/**
+ * @brief Returns the NULL-terminated `NAME=value` array of exported
+ * variables.
+ *
+ * The array is owned by the environment and stays valid until the next set
+ * or unset.
+ */
+char **environment_envp(t_environment *environment);
+bool environment_is_exported(const char *name);
+
+/**
+ * @brief Resolves a command name to the path it would be executed from.
+ *
+ * Names containing a slash are returned as is. Other names are searched in
+ * `PATH` once; later lookups, including failed ones, are answered from the
+ * cache without any system call until `PATH` changes.
+ *
+ * @return The path, or NULL if the command was not found.
+ */
+const char *environment_command_path(t_environment *environment,
+                                     const char *name);
+void environment_command_forget(t_environment *environment, const char *name);
+void environment_commands_reset(t_environment *environment);
 
 #endif
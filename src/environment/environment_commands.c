@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "environment.h"
+#include "ft_hashmap.h"
+#include "ft_stdlib.h"
+#include "ft_string.h"
+
+/**
+ * @brief Searches `PATH` for an executable regular file called `name`.
+ *
+ * @return The path as a new string, or an empty string if there is none.
+ */
+static t_string environment_search_path(const t_environment *environment,
+                                        const char *name) {
+  const char *path = environment_get(environment, "PATH");
+  size_t name_length = strlen(name);
+
+  while (path) {
+    const char *colon = strchr(path, ':');
+    size_t dir_length = colon ? (size_t)(colon - path) : strlen(path);
+
+    // An empty entry stands for the current directory
+    char candidate[dir_length + name_length + 3];
+    size_t length = 0;
+    if (dir_length == 0) candidate[length++] = '.';
+    memcpy(candidate + length, path, dir_length);
+    length += dir_length;
+    candidate[length++] = '/';
+    memcpy(candidate + length, name, name_length + 1);
+
+    struct stat st;
+    if (stat(candidate, &st) == 0 && S_ISREG(st.st_mode) &&
+        access(candidate, X_OK) == 0) {
+      return ft_expect(ft_stnnew(candidate), __func__);
+    }
+
+    path = colon ? colon + 1 : NULL;
+  }
+
+  return ft_expect(ft_stnnew(""), __func__);
+}
+
+const char *environment_command_path(t_environment *environment,
+                                     const char *name) {
+  if (strchr(name, '/')) return name;
+
+  const char *path = ft_hshget(environment->commands, name);
+  if (!path) {
+    t_string key = ft_expect(ft_stnnew(name), __func__);
+    t_string found = environment_search_path(environment, name);
+    if (!ft_hshset(environment->commands, key, found)) {
+      ft_panic(__func__);
+    }
+    path = found;
+  }
+
+  return *path ? path : NULL;
+}
+
+void environment_command_forget(t_environment *environment, const char *name) {
+  ft_hshdel2(environment->commands, name, ft_stnfree, ft_stnfree);
+}
+
+void environment_commands_reset(t_environment *environment) {
+  t_hashmap_iterator it = ft_hshbegin(environment->commands);
+  while (ft_hshnext(&it)) {
+    // Restart after each removal rather than rely on the iterator surviving it
+    environment_command_forget(environment, it.key);
+    it = ft_hshbegin(environment->commands);
+  }
+}
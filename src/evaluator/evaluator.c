@@ -1,281 +1,411 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "evaluator.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "builtin/builtin.h"
 #include "evaluator_internal.h"
+#include "expander/expander.h"
+#include "job/job.h"
 #include "ft_ansi.h"
 #include "ft_stdlib.h"
 #include "ft_string.h"
 #include "minishell.h"
+#include "reaper/reaper.h"
+
+int evaluator_evaluate(const t_ast *ast, t_environment *environment,
+                       t_arena *arena) {
+  return evaluator_run(evaluator_compile(ast, arena), environment, arena);
+}
 
-int evaluator_evaluate(t_ast *ast, t_hashmap *environment) {
+int evaluator_run(const t_program *program, t_environment *environment,
+                  t_arena *arena) {
+  t_evaluator evaluator = {
+      .environment = environment, .arena = arena, .exec_in_place = false};
   t_io_context io = {.in_fd = STDIN_FILENO,
                      .out_fd = STDOUT_FILENO,
                      .needs_close_in = false,
                      .needs_close_out = false};
 
-  if (!ast) return EXIT_SUCCESS;
-
-  int status;
+  return evaluator_execute(program, 0, &evaluator, io);
+}
 
-  switch (ast->type) {
-    case AST_LIST:
-      status = evaluator_list(ast, environment, io);
-      break;
-    case AST_AND_OR:
-      status = evaluator_and_or(ast, environment, io);
-      break;
-    case AST_PIPE_SEQUENCE:
-      status = evaluator_pipe_sequence(ast, environment, io);
-      break;
-    case AST_SUBSHELL:
-      status = evaluator_subshell(ast, environment, io);
-      break;
-    case AST_SIMPLE_COMMAND:
-      status = evaluator_simple_command(ast, environment, io);
-      break;
-    default:
-      fprintf(stderr, "%s: unhandled AST node type: %s\n", MINISHELL_NAME,
-              ast_type_to_string(ast->type));
-      status = EXIT_FAILURE;
+void evaluator_pipeline_begin(t_evaluator_pipeline *pipeline,
+                              const t_instruction *instruction,
+                              t_evaluator *evaluator, t_io_context io) {
+  const t_ast *ast = instruction->node;
+  size_t count = ast->pipe_sequence.count;
+
+  *pipeline = (t_evaluator_pipeline){
+      .ast = ast,
+      .count = count,
+      .wait = instruction->target,
+      .pids = arena_alloc(evaluator->arena, count * sizeof(pid_t)),
+      .statuses = arena_alloc(evaluator->arena, count * sizeof(int)),
+      .deferred = arena_calloc(evaluator->arena, count * sizeof(t_io_context)),
+      .blocks = arena_alloc(evaluator->arena, count * sizeof(size_t)),
+      .held_fds = arena_alloc(evaluator->arena, (2 * count + 1) * sizeof(int)),
+      .in_fd = io.in_fd,
+      .pipe_fds = {-1, io.out_fd},
+      .io = io,
+  };
+
+  if (ast->pipe_sequence.timing != AST_TIMING_NONE) {
+    pipeline->timings = arena_calloc(evaluator->arena,
+                                     count * sizeof(t_evaluator_timing));
   }
-
-  return status;
 }
 
-int evaluator_list(t_ast *ast, t_hashmap *environment, t_io_context io) {
-  int status;
-
-  status = evaluator_evaluate(ast->list.left, environment);
-  if (ast->list.right) {
-    status = evaluator_evaluate(ast->list.right, environment);
+bool evaluator_pipeline_pipe(t_evaluator_pipeline *pipeline) {
+  if (evaluator_pipe(pipeline->pipe_fds) == -1) {
+    perror(MINISHELL_NAME);
+    return false;
   }
-
-  return status;
+  return true;
 }
 
-int evaluator_and_or(t_ast *ast, t_hashmap *environment, t_io_context io) {
-  int left_status = evaluator_evaluate(ast->and_or.left, environment);
+bool evaluator_pipeline_spawn(t_evaluator_pipeline *pipeline,
+                              const t_program *program, size_t block,
+                              t_evaluator *evaluator) {
+  // Every stage is a direct child of the shell; nothing is waited for until
+  // the whole pipeline is running.
+  size_t started = pipeline->started++;
+  const t_ast *stage = pipeline->ast->pipe_sequence.children[started];
+  bool is_last = started + 1 == pipeline->count;
+  int *pipe_fds = pipeline->pipe_fds;
+  int in_fd = pipeline->in_fd;
+  t_io_context io = pipeline->io;
+
+  t_io_context stage_io = {
+      .in_fd = in_fd,
+      .out_fd = pipe_fds[1],
+      .needs_close_in = in_fd != io.in_fd || io.needs_close_in,
+      .needs_close_out = !is_last || io.needs_close_out,
+  };
+  pipeline->pids[started] = -1;
+  pipeline->blocks[started] = block;
+  if (pipeline->timings) evaluator_time_start(&pipeline->timings[started]);
+
+  // Builtins that may run in the shell wait until the other stages are
+  // running; the shell holds their descriptors until then.
+  if (evaluator_runs_in_shell(stage)) {
+    pipeline->deferred[started] = stage_io;
+    if (in_fd != io.in_fd) pipeline->held_fds[pipeline->held_count++] = in_fd;
+    if (!is_last) pipeline->held_fds[pipeline->held_count++] = pipe_fds[1];
+    pipeline->in_fd = pipe_fds[0];
+    pipe_fds[0] = -1;
+    pipe_fds[1] = io.out_fd;
+    return true;
+  }
+
+  pipeline->held_fds[pipeline->held_count] = pipe_fds[0];
+  pipeline->pids[started] = evaluator_start_stage(
+      program, block, evaluator, stage_io, pipeline->held_fds,
+      pipeline->held_count + (pipe_fds[0] != -1),
+      &pipeline->statuses[started]);
+
+  // Keep only the read end the next stage will inherit
+  if (in_fd != io.in_fd) close(in_fd);
+  if (!is_last) close(pipe_fds[1]);
+  pipeline->in_fd = pipe_fds[0];
+  pipe_fds[0] = -1;
+  pipe_fds[1] = io.out_fd;
+
+  return pipeline->pids[started] != -1 || pipeline->statuses[started] != -1;
+}
 
-  if (ast->and_or.op->type == TOKEN_AND_IF) {
-    // Execute right side only if left side succeeded
-    if (left_status == EXIT_SUCCESS) {
-      return evaluator_evaluate(ast->and_or.right, environment);
-    }
-    return left_status;
-  } else if (ast->and_or.op->type == TOKEN_OR_IF) {
-    // Execute right side only if left side failed
-    if (left_status != EXIT_SUCCESS) {
-      return evaluator_evaluate(ast->and_or.right, environment);
+int evaluator_pipeline_wait(t_evaluator_pipeline *pipeline,
+                            const t_program *program,
+                            t_evaluator *evaluator) {
+  size_t count = pipeline->count;
+  size_t started = pipeline->started;
+  int *statuses = pipeline->statuses;
+  t_evaluator_timing *timings = pipeline->timings;
+
+  if (pipeline->in_fd != pipeline->io.in_fd && pipeline->in_fd != -1) {
+    close(pipeline->in_fd);
+  }
+
+  // From right to left: a builtin never reads its input, so its pipe is
+  // closed before the stage feeding it writes, which then fails with EPIPE
+  // instead of blocking on a full pipe. Like the stages in processes of
+  // their own, they leave `$?` to the pipeline.
+  int saved_status = evaluator->environment->status;
+  for (size_t i = started; i-- > 0;) {
+    const t_ast *stage = pipeline->ast->pipe_sequence.children[i];
+    size_t block = pipeline->blocks[i];
+    if (!evaluator_runs_in_shell(stage)) continue;
+    if (started == count && timings) {
+      statuses[i] = evaluator_time_in_shell(
+          program, block, evaluator, pipeline->deferred[i], &timings[i]);
+    } else if (started == count) {
+      statuses[i] = evaluator_run_in_shell(program, block, evaluator,
+                                           pipeline->deferred[i]);
+    } else {
+      evaluator_close_io(&pipeline->deferred[i]);
     }
-    return left_status;
+    evaluator->environment->status = saved_status;
   }
 
-  return left_status;
-}
-
-int evaluator_pipe_sequence(t_ast *ast, t_hashmap *environment,
-                            t_io_context io) {
-  int pipe_fds[2];
-  pid_t left_pid, right_pid;
-  int status = EXIT_SUCCESS;
-
-  if (pipe(pipe_fds) == -1) {
-    perror(MINISHELL_NAME);
-    return EXIT_FAILURE;
+  for (size_t i = 0; i < started; ++i) {
+    if (pipeline->pids[i] != -1) {
+      statuses[i] = evaluator_wait(pipeline->pids[i],
+                                   timings ? &timings[i].usage : NULL);
+    }
   }
 
-  left_pid = fork();
-  if (left_pid == -1) {
-    perror(MINISHELL_NAME);
-    close(pipe_fds[0]);
-    close(pipe_fds[1]);
-    return EXIT_FAILURE;
+  if (timings && started == count) {
+    evaluator_time_report(pipeline->ast, timings, statuses, count);
   }
 
-  if (left_pid == 0) {
-    // Child process (left side of pipe)
-    close(pipe_fds[0]);
-    t_io_context child_io = {.in_fd = io.in_fd,
-                             .out_fd = pipe_fds[1],
-                             .needs_close_in = io.needs_close_in,
-                             .needs_close_out = true};
-
-    int exit_status = evaluator_evaluate(ast->pipe_sequence.left, environment);
-    exit(exit_status);
+  // The pipeline's status is the status of its last command
+  if (started == count && statuses[count - 1] != -1) {
+    return statuses[count - 1];
   }
 
-  // Parent continues
-  right_pid = fork();
-  if (right_pid == -1) {
-    perror(MINISHELL_NAME);
-    close(pipe_fds[0]);
-    close(pipe_fds[1]);
-    return EXIT_FAILURE;
+  return EXIT_FAILURE;
+}
+
+bool evaluator_runs_in_shell(const t_ast *ast) {
+  if (ast->type != AST_SIMPLE_COMMAND || ast->simple_command.argc == 0) {
+    return false;
   }
 
-  if (right_pid == 0) {
-    // Child process (right side of pipe)
-    close(pipe_fds[1]);
-    t_io_context child_io = {.in_fd = pipe_fds[0],
-                             .out_fd = io.out_fd,
-                             .needs_close_in = true,
-                             .needs_close_out = io.needs_close_out};
+  const t_builtin *builtin = builtin_find(ast->simple_command.argv[0]);
+  return builtin && builtin->flags & BUILTIN_NO_FORK;
+}
 
-    int exit_status = evaluator_evaluate(ast->pipe_sequence.right, environment);
-    exit(exit_status);
-  }
+int evaluator_run_in_shell(const t_program *program, size_t block,
+                           t_evaluator *evaluator, t_io_context io) {
+  sigset_t pipe_signal;
+  sigset_t saved;
 
-  // Parent closes both pipe ends
-  close(pipe_fds[0]);
-  close(pipe_fds[1]);
+  // Writing to a pipe nobody reads must fail with EPIPE, not kill the shell
+  sigemptyset(&pipe_signal);
+  sigaddset(&pipe_signal, SIGPIPE);
+  sigprocmask(SIG_BLOCK, &pipe_signal, &saved);
 
-  // Wait for both children
-  int status_left, status_right;
-  waitpid(left_pid, &status_left, 0);
-  waitpid(right_pid, &status_right, 0);
+  int status = evaluator_execute(program, block, evaluator, io);
 
-  // Return status of the right command
-  if (WIFEXITED(status_right)) {
-    return WEXITSTATUS(status_right);
+  struct timespec poll = {.tv_sec = 0, .tv_nsec = 0};
+  while (sigtimedwait(&pipe_signal, NULL, &poll) == SIGPIPE) {
   }
+  sigprocmask(SIG_SETMASK, &saved, NULL);
 
-  return EXIT_FAILURE;
+  return status;
 }
 
-int evaluator_subshell(t_ast *ast, t_hashmap *environment, t_io_context io) {
-  pid_t pid = fork();
+pid_t evaluator_start_stage(const t_program *program, size_t block,
+                            t_evaluator *evaluator, t_io_context io,
+                            const int *held_fds, size_t held_count,
+                            int *status) {
+  const t_ast *ast = program->code[block - 1].node;
+
+  // External commands are spawned from the shell itself, without an
+  // intermediate shell process to forward their status.
+  size_t argc = 0;
+  const char **argv = NULL;
+
+  if (ast->type == AST_SIMPLE_COMMAND) {
+    argc = ast->simple_command.argc;
+    argv = evaluator_expand_argv(ast, evaluator, &argc);
+  }
+  if (argv && !(argc > 0 && evaluator_is_builtin(argv[0]))) {
+    bool redirected = true;
+    for (size_t i = 0; redirected && i < ast->simple_command.io_file_count;
+         ++i) {
+      redirected = evaluator_apply_io_file(&ast->simple_command.io_files[i],
+                                           evaluator, &io);
+    }
 
+    // A command whose redirections failed is not run
+    if (argc == 0 || !redirected) {
+      evaluator_close_io(&io);
+      *status = redirected ? EXIT_SUCCESS : EXIT_FAILURE;
+      return -1;
+    }
+    return evaluator_start_external(argv, evaluator, io, status);
+  }
+
+  // Anything else needs a shell of its own
+  pid_t pid = fork();
   if (pid == -1) {
     perror(MINISHELL_NAME);
-    return EXIT_FAILURE;
+    *status = -1;
+    return -1;
   }
 
   if (pid == 0) {
-    // Child process
-    if (io.needs_close_in && dup2(io.in_fd, STDIN_FILENO) == -1) {
-      perror(MINISHELL_NAME);
-      exit(EXIT_FAILURE);
-    }
+    // Descriptors the shell keeps for other stages are not ours
+    for (size_t i = 0; i < held_count; ++i) close(held_fds[i]);
+    evaluator->exec_in_place = true;
+    exit(evaluator_execute(program, block, evaluator, io));
+  }
 
-    if (io.needs_close_out && dup2(io.out_fd, STDOUT_FILENO) == -1) {
-      perror(MINISHELL_NAME);
-      exit(EXIT_FAILURE);
-    }
+  reaper_watch(pid);
+  return pid;
+}
 
-    // Close fds if needed
-    evaluator_close_io(&io);
+int evaluator_subshell(const t_program *program, size_t block, bool tail,
+                       t_evaluator *evaluator, t_io_context io) {
+  pid_t pid = -1;
 
-    int exit_status = evaluator_evaluate(ast->subshell.and_or, environment);
-    exit(exit_status);
+  // A disposable process is already isolated from the shell
+  if (!evaluator->exec_in_place || !tail) {
+    pid = fork();
+    if (pid == -1) {
+      perror(MINISHELL_NAME);
+      return EXIT_FAILURE;
+    }
+    if (pid != 0) return evaluator_wait(pid, NULL);
+    evaluator->exec_in_place = true;
   }
 
-  // Parent process
-  int status;
-  waitpid(pid, &status, 0);
+  // The redirections become the standard streams of the whole list
+  if (io.needs_close_in && dup2(io.in_fd, STDIN_FILENO) == -1) {
+    perror(MINISHELL_NAME);
+    exit(EXIT_FAILURE);
+  }
 
-  if (WIFEXITED(status)) {
-    return WEXITSTATUS(status);
+  if (io.needs_close_out && dup2(io.out_fd, STDOUT_FILENO) == -1) {
+    perror(MINISHELL_NAME);
+    exit(EXIT_FAILURE);
   }
 
-  return EXIT_FAILURE;
+  // Close fds if needed
+  evaluator_close_io(&io);
+
+  int status = evaluator_execute(program, block, evaluator, io);
+  if (pid == 0) exit(status);
+  return status;
 }
 
-int evaluator_simple_command(t_ast *ast, t_hashmap *environment,
-                             t_io_context io) {
-  // Apply any IO redirections from cmd_prefix
-  if (ast->simple_command.cmd_prefix) {
-    t_ast *prefix = ast->simple_command.cmd_prefix;
-    while (prefix) {
-      if (prefix->cmd_prefix.io_file) {
-        io = evaluator_apply_io_file(prefix->cmd_prefix.io_file, io);
-      }
-      prefix = prefix->cmd_prefix.cmd_prefix;
-    }
+int evaluator_background(const t_program *program, size_t block,
+                         t_evaluator *evaluator, t_io_context io) {
+  const t_ast *command = program->code[block - 1].node;
+
+  pid_t pid = fork();
+
+  if (pid == -1) {
+    perror(MINISHELL_NAME);
+    return EXIT_FAILURE;
   }
 
-  // Apply any IO redirections from cmd_suffix
-  if (ast->simple_command.cmd_suffix) {
-    t_ast *suffix = ast->simple_command.cmd_suffix;
-    while (suffix) {
-      if (suffix->cmd_suffix.io_file) {
-        io = evaluator_apply_io_file(suffix->cmd_suffix.io_file, io);
+  if (pid == 0) {
+    // The job gets a process group of its own, out of reach of the
+    // terminal's interrupt, and without job control it does not read the
+    // terminal either.
+    setpgid(0, 0);
+    if (io.in_fd == STDIN_FILENO) {
+      int null_fd = open("/dev/null", O_RDONLY);
+      if (null_fd != -1 && null_fd != STDIN_FILENO) {
+        dup2(null_fd, STDIN_FILENO);
+        close(null_fd);
       }
-      suffix = suffix->cmd_suffix.cmd_suffix;
     }
+    evaluator->exec_in_place = true;
+    exit(evaluator_execute(program, block, evaluator, io));
+  }
+
+  // Set from both sides so the group exists whichever runs first
+  setpgid(pid, pid);
+  int number = job_add(pid, command);
+  if (isatty(STDIN_FILENO)) {
+    fprintf(stderr, "[%d] %ld\n", number, (long)pid);
+  }
+  return EXIT_SUCCESS;
+}
+
+int evaluator_exec_command(const char **argv, size_t argc,
+                           t_evaluator *evaluator, t_io_context io,
+                           bool in_place) {
+  // A command made only of redirections just creates or opens the files
+  if (argc == 0) {
+    evaluator_close_io(&io);
+    return EXIT_SUCCESS;
   }
 
   // Check for builtin commands
-  if (evaluator_is_builtin(ast->simple_command.cmd_name)) {
-    return evaluator_execute_builtin(ast, environment, io);
+  if (evaluator_is_builtin(argv[0])) {
+    return evaluator_execute_builtin(argv, evaluator, io);
   }
 
   // External command
-  return evaluator_execute_external(ast, environment, io);
+  if (in_place) return evaluator_replace_process(argv, evaluator, io);
+  return evaluator_execute_external(argv, evaluator, io);
 }
 
-t_io_context evaluator_apply_io_file(t_ast *io_file, t_io_context io) {
-  int fd;
+const char **evaluator_expand_argv(const t_ast *ast, t_evaluator *evaluator,
+                                   size_t *argc) {
+  return expander_argv(ast->simple_command.argv,
+                       ast->simple_command.expansions, argc,
+                       evaluator->environment, evaluator->arena);
+}
 
-  // Clean up previous redirections if needed
-  if (io.needs_close_in && io.in_fd != STDIN_FILENO) {
-    close(io.in_fd);
-    io.in_fd = STDIN_FILENO;
-    io.needs_close_in = false;
-  }
+bool evaluator_apply_io_file(const t_io_file *io_file, t_evaluator *evaluator,
+                             t_io_context *io) {
+  const char *filename = io_file->filename;
+  int fd;
 
-  if (io.needs_close_out && io.out_fd != STDOUT_FILENO) {
-    close(io.out_fd);
-    io.out_fd = STDOUT_FILENO;
-    io.needs_close_out = false;
+  if (io_file->expansion && io_file->op->type != TOKEN_DLESS) {
+    filename = expander_word(io_file->expansion, evaluator->environment,
+                             evaluator->arena);
   }
 
-  switch (io_file->io_file.op->type) {
+  switch (io_file->op->type) {
     case TOKEN_LESS:  // <
-      fd = open(io_file->io_file.filename, O_RDONLY);
-      if (fd == -1) {
-        perror(io_file->io_file.filename);
-        return io;
-      }
-      io.in_fd = fd;
-      io.needs_close_in = true;
+      fd = open(filename, O_RDONLY | O_CLOEXEC);
       break;
 
     case TOKEN_GREAT:  // >
-      fd = open(io_file->io_file.filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-      if (fd == -1) {
-        perror(io_file->io_file.filename);
-        return io;
-      }
-      io.out_fd = fd;
-      io.needs_close_out = true;
+      fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
       break;
 
     case TOKEN_DGREAT:  // >>
-      fd = open(io_file->io_file.filename, O_WRONLY | O_CREAT | O_APPEND, 0644);
-      if (fd == -1) {
-        perror(io_file->io_file.filename);
-        return io;
-      }
-      io.out_fd = fd;
-      io.needs_close_out = true;
+      fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
       break;
 
     case TOKEN_DLESS:  // << (Here document)
-      // For simplicity in this version, not implementing heredoc
-      fprintf(stderr, "Heredoc redirection not yet implemented\n");
-      break;
+      // The body was collected after parsing; its descriptor belongs to the
+      // AST and is closed with it, not by the command.
+      if (io_file->fd == -1) return true;
+      if (io->needs_close_in && io->in_fd != STDIN_FILENO) close(io->in_fd);
+      io->in_fd = io_file->fd;
+      io->needs_close_in = false;
+      return true;
 
     default:
-      break;
+      return true;
+  }
+
+  if (fd == -1) {
+    fprintf(stderr, MINISHELL_NAME ": %s: %s\n", filename, strerror(errno));
+    return false;
   }
 
-  return io;
+  // Replace only the side this redirection applies to
+  if (io_file->op->type == TOKEN_LESS) {
+    if (io->needs_close_in && io->in_fd != STDIN_FILENO) close(io->in_fd);
+    io->in_fd = fd;
+    io->needs_close_in = true;
+  } else {
+    if (io->needs_close_out && io->out_fd != STDOUT_FILENO) {
+      close(io->out_fd);
+    }
+    io->out_fd = fd;
+    io->needs_close_out = true;
+  }
+
+  return true;
 }
 
 void evaluator_close_io(t_io_context *io) {
@@ -293,109 +423,15 @@ void evaluator_close_io(t_io_context *io) {
 }
 
 bool evaluator_is_builtin(const char *cmd_name) {
-  static const char *builtins[] = {"cd",     "echo", "env",   "exit",
-                                   "export", "pwd",  "unset", NULL};
-
-  for (int i = 0; builtins[i]; i++) {
-    if (strcmp(cmd_name, builtins[i]) == 0) {
-      return true;
-    }
-  }
-
-  return false;
+  return builtin_find(cmd_name) != NULL;
 }
 
-int evaluator_execute_builtin(t_ast *ast, t_hashmap *environment,
+int evaluator_execute_builtin(const char **argv, t_evaluator *evaluator,
                               t_io_context io) {
-  const char *cmd_name = ast->simple_command.cmd_name;
-  int status = EXIT_SUCCESS;
-
-  // Save stdin/stdout if needed for redirection
-  int saved_stdin = -1;
-  int saved_stdout = -1;
-
-  if (io.in_fd != STDIN_FILENO) {
-    saved_stdin = dup(STDIN_FILENO);
-    dup2(io.in_fd, STDIN_FILENO);
-  }
-
-  if (io.out_fd != STDOUT_FILENO) {
-    saved_stdout = dup(STDOUT_FILENO);
-    dup2(io.out_fd, STDOUT_FILENO);
-  }
-
-  // Build argv
-  char **argv = evaluator_build_argv(ast);
-  if (!argv) {
-    status = EXIT_FAILURE;
-    goto cleanup;
-  }
-
-  // Execute the built-in command
-  if (strcmp(cmd_name, "cd") == 0) {
-    if (!argv[1]) {
-      fprintf(stderr, "%s: cd: missing argument\n", MINISHELL_NAME);
-      status = EXIT_FAILURE;
-    } else if (chdir(argv[1]) == -1) {
-      perror(argv[1]);
-      status = EXIT_FAILURE;
-    }
-  } else if (strcmp(cmd_name, "exit") == 0) {
-    // TODO: Implement proper exit with status code
-    exit(EXIT_SUCCESS);
-  } else if (strcmp(cmd_name, "env") == 0) {
-    environment_print(environment);
-  } else if (strcmp(cmd_name, "export") == 0) {
-    // TODO: Implement export command
-    fprintf(stderr, "export: not yet implemented\n");
-  } else if (strcmp(cmd_name, "unset") == 0) {
-    if (argv[1]) {
-      environment_unset(environment, argv[1]);
-    }
-  } else if (strcmp(cmd_name, "echo") == 0) {
-    bool newline = true;
-    int i = 1;
-
-    if (argv[i] && strcmp(argv[i], "-n") == 0) {
-      newline = false;
-      i++;
-    }
-
-    while (argv[i]) {
-      if (i > 1 && (argv[i - 1] && strcmp(argv[i - 1], "-n") != 0)) {
-        printf(" ");
-      }
-      printf("%s", argv[i]);
-      i++;
-    }
-
-    if (newline) {
-      printf("\n");
-    }
-  } else if (strcmp(cmd_name, "pwd") == 0) {
-    char pwd[4096];
-    if (getcwd(pwd, sizeof(pwd)) != NULL) {
-      printf("%s\n", pwd);
-    } else {
-      perror("pwd");
-      status = EXIT_FAILURE;
-    }
-  }
-
-  // Free argv
-  free(argv);
-
-cleanup:
-  // Restore stdin/stdout if redirected
-  if (saved_stdin != -1) {
-    dup2(saved_stdin, STDIN_FILENO);
-    close(saved_stdin);
-  }
-
-  if (saved_stdout != -1) {
-    dup2(saved_stdout, STDOUT_FILENO);
-    close(saved_stdout);
-  }
+  // Builtins write to the redirection targets themselves; the shell's own
+  // standard streams are never swapped.
+  const t_builtin *builtin = builtin_find(argv[0]);
+  int status = builtin->handler(argv, evaluator->environment, io);
 
   // Close any redirected file descriptors
   evaluator_close_io(&io);
@@ -403,133 +439,64 @@ cleanup:
   return status;
 }
 
-int evaluator_execute_external(t_ast *ast, t_hashmap *environment,
+int evaluator_execute_external(const char **argv, t_evaluator *evaluator,
                                t_io_context io) {
-  pid_t pid = fork();
-
-  if (pid == -1) {
-    perror(MINISHELL_NAME);
-    evaluator_close_io(&io);
-    return EXIT_FAILURE;
-  }
-
-  if (pid == 0) {
-    // Child process
-
-    // Set up redirections
-    if (io.in_fd != STDIN_FILENO) {
-      if (dup2(io.in_fd, STDIN_FILENO) == -1) {
-        perror(MINISHELL_NAME);
-        exit(EXIT_FAILURE);
-      }
-    }
-
-    if (io.out_fd != STDOUT_FILENO) {
-      if (dup2(io.out_fd, STDOUT_FILENO) == -1) {
-        perror(MINISHELL_NAME);
-        exit(EXIT_FAILURE);
-      }
-    }
-
-    // Close file descriptors
-    evaluator_close_io(&io);
-
-    // Build argv and envp
-    char **argv = evaluator_build_argv(ast);
-    char **envp = evaluator_build_envp(environment);
-
-    if (!argv || !envp) {
-      fprintf(stderr, "%s: memory allocation error\n", MINISHELL_NAME);
-      exit(EXIT_FAILURE);
-    }
-
-    // Execute the command
-    execve(argv[0], argv, envp);
-
-    // If execve returns, there was an error
-    fprintf(stderr, "%s: command not found: %s\n", MINISHELL_NAME, argv[0]);
-
-    // Clean up and exit
-    free(argv);
-    free(envp);
-    exit(EXIT_FAILURE);
-  }
-
-  // Parent process
-  evaluator_close_io(&io);
-
   int status;
-  waitpid(pid, &status, 0);
-
-  if (WIFEXITED(status)) {
-    return WEXITSTATUS(status);
-  }
+  pid_t pid = evaluator_start_external(argv, evaluator, io, &status);
 
-  return EXIT_FAILURE;
+  if (pid == -1) return status;
+  return evaluator_wait(pid, NULL);
 }
 
-char **evaluator_build_argv(t_ast *ast) {
-  // Count arguments
-  int argc = 1;  // Start with 1 for the command name
+pid_t evaluator_start_external(const char **command, t_evaluator *evaluator,
+                               t_io_context io, int *status) {
+  char **argv = (char **)command;
+  const char *path = environment_command_path(evaluator->environment, argv[0]);
 
-  // Count words in cmd_suffix
-  t_ast *suffix = ast->simple_command.cmd_suffix;
-  while (suffix) {
-    if (suffix->cmd_suffix.word) {
-      argc++;
-    }
-    suffix = suffix->cmd_suffix.cmd_suffix;
+  if (!path) {
+    evaluator_close_io(&io);
+    *status = evaluator_exec_error(argv[0], ENOENT);
+    return -1;
   }
 
-  // Allocate argv array (argc + 1 for NULL terminator)
-  char **argv = ft_expect(calloc(argc + 1, sizeof(char *)), __func__);
-
-  // Set command name
-  argv[0] = (char *)ast->simple_command.cmd_name;
+  char **envp = environment_envp(evaluator->environment);
+  pid_t pid = evaluator_launch(path, argv, envp, io);
 
-  // Add arguments from cmd_suffix
-  int i = 1;
-  suffix = ast->simple_command.cmd_suffix;
-  while (suffix) {
-    if (suffix->cmd_suffix.word) {
-      argv[i++] = (char *)suffix->cmd_suffix.word;
-    }
-    suffix = suffix->cmd_suffix.cmd_suffix;
+  // A hashed command may have been removed since; search PATH again once
+  if (pid == -1 && errno == ENOENT && path != argv[0]) {
+    environment_command_forget(evaluator->environment, argv[0]);
+    path = environment_command_path(evaluator->environment, argv[0]);
+    if (path) pid = evaluator_launch(path, argv, envp, io);
   }
 
-  argv[argc] = NULL;
-  return argv;
+  int error = errno;
+  evaluator_close_io(&io);
+
+  if (pid == -1) *status = evaluator_exec_error(argv[0], error);
+  return pid;
 }
 
-char **evaluator_build_envp(t_hashmap *environment) {
-  // Count environment variables
-  t_hashmap_iterator it = ft_hshbegin(environment);
-  int env_count = 0;
+int evaluator_replace_process(const char **command, t_evaluator *evaluator,
+                              t_io_context io) {
+  char **argv = (char **)command;
+  const char *path = environment_command_path(evaluator->environment, argv[0]);
 
-  while (ft_hshnext(&it)) {
-    env_count++;
+  if (!path) {
+    evaluator_close_io(&io);
+    return evaluator_exec_error(argv[0], ENOENT);
   }
 
-  // Allocate envp array (env_count + 1 for NULL terminator)
-  char **envp = ft_expect(calloc(env_count + 1, sizeof(char *)), __func__);
-
-  // Build envp entries
-  it = ft_hshbegin(environment);
-  int i = 0;
-
-  while (ft_hshnext(&it)) {
-    // Format: KEY=VALUE
-    size_t key_len = strlen(it.key);
-    size_t value_len = strlen((char *)it.value);
-    char *entry = ft_expect(malloc(key_len + 1 + value_len + 1), __func__);
-
-    strcpy(entry, it.key);
-    entry[key_len] = '=';
-    strcpy(entry + key_len + 1, (char *)it.value);
+  char **envp = environment_envp(evaluator->environment);
+  evaluator_exec(path, argv, envp, io);
 
-    envp[i++] = entry;
+  // A hashed command may have been removed since; the redirections are
+  // already in place, so only the search and execve() are repeated.
+  if (errno == ENOENT && path != argv[0]) {
+    environment_command_forget(evaluator->environment, argv[0]);
+    path = environment_command_path(evaluator->environment, argv[0]);
+    if (!path) return evaluator_exec_error(argv[0], ENOENT);
+    execve(path, argv, envp);
   }
 
-  envp[env_count] = NULL;
-  return envp;
+  return evaluator_exec_error(argv[0], errno);
 }
@@ -1,16 +1,86 @@
 #ifndef EVALUATOR_H
 #define EVALUATOR_H
 
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "arena/arena.h"
 #include "ast/ast.h"
 #include "environment/environment.h"
 
 /**
- * @brief Evaluates an AST and executes the commands.
+ * @brief Exit statuses for commands that could not be run, as in POSIX sh.
+ */
+#define EVALUATOR_STATUS_NOT_EXECUTABLE 126
+#define EVALUATOR_STATUS_NOT_FOUND 127
+#define EVALUATOR_STATUS_SIGNALED 128
+
+/**
+ * @brief The descriptors a command reads from and writes to.
+ *
+ * `needs_close_in` and `needs_close_out` mark descriptors opened for this
+ * command, which must be closed once it has been started.
+ */
+typedef struct s_io_context {
+  int in_fd;
+  int out_fd;
+  bool needs_close_in;
+  bool needs_close_out;
+} t_io_context;
+
+/**
+ * @brief A tree compiled to a flat sequence of instructions.
+ */
+typedef struct s_program t_program;
+
+/**
+ * @brief Compiles `ast` into `arena`; the program points into the tree,
+ * which must outlive it.
+ */
+t_program *evaluator_compile(const t_ast *ast, t_arena *arena);
+
+/**
+ * @brief Executes a compiled program.
+ *
+ * @param program The program to run, which is never modified.
+ * @param environment The environment variables.
+ * @param arena The arena scratch allocations are made from.
+ * @return The exit status of the last command executed.
+ */
+int evaluator_run(const t_program *program, t_environment *environment,
+                  t_arena *arena);
+
+/**
+ * @brief Prints the instructions of `program`, for debugging.
+ */
+void evaluator_program_print(const t_program *program);
+
+/**
+ * @brief Compiles an AST into the scratch arena and executes it.
  *
  * @param ast The abstract syntax tree to evaluate.
  * @param environment The environment variables.
+ * @param arena The arena scratch allocations are made from.
  * @return The exit status of the last command executed.
  */
-int evaluator_evaluate(t_ast *ast, t_hashmap *environment);
+int evaluator_evaluate(const t_ast *ast, t_environment *environment,
+                       t_arena *arena);
+
+/**
+ * @brief Converts a status reported by `waitpid` to an exit status, with
+ * `EVALUATOR_STATUS_SIGNALED` added to the number of a killing signal.
+ */
+int evaluator_status(int wait_status);
+
+/**
+ * @brief Starts the executable at `path` with `io` as its standard input and
+ * output, without waiting for it.
+ *
+ * The caller keeps ownership of the descriptors in `io`.
+ *
+ * @return The pid of the new process, or -1 with `errno` set.
+ */
+pid_t evaluator_launch(const char *path, char **argv, char **envp,
+                       t_io_context io);
 
 #endif
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+
+#include "evaluator.h"
+#include "evaluator_internal.h"
+
+/**
+ * @brief Counts the instructions `ast` compiles to, so a program is
+ * allocated once.
+ */
+static size_t evaluator_compile_size(const t_ast *ast) {
+  size_t size = 0;
+
+  switch (ast->type) {
+    case AST_LIST:
+      for (size_t i = 0; i < ast->list.count; ++i) {
+        size += evaluator_compile_size(ast->list.children[i]);
+      }
+      return size;
+    case AST_AND_OR:
+      // A jump before each operand but the first
+      for (size_t i = 0; i < ast->and_or.count; ++i) {
+        size += evaluator_compile_size(ast->and_or.children[i]) + (i > 0);
+      }
+      return size;
+    case AST_PIPE_SEQUENCE:
+      // `PIPELINE` and `WAIT`, and for each stage `SPAWN`, its block and
+      // `RETURN`, after a `PIPE` unless it is the last
+      for (size_t i = 0; i < ast->pipe_sequence.count; ++i) {
+        size += evaluator_compile_size(ast->pipe_sequence.children[i]) + 2 +
+                (i + 1 < ast->pipe_sequence.count);
+      }
+      return size + 2;
+    case AST_SUBSHELL:
+      return evaluator_compile_size(ast->subshell.list) + 2;
+    case AST_BACKGROUND:
+      return evaluator_compile_size(ast->background.command) + 2;
+    case AST_SIMPLE_COMMAND:
+      return ast->simple_command.io_file_count + 2;
+  }
+  return 0;
+}
+
+static size_t evaluator_emit(t_program *program, t_evaluator_op op, bool tail,
+                             const t_ast *node) {
+  program->code[program->count] = (t_instruction){
+      .op = op,
+      .tail = tail,
+      .node = node,
+  };
+  return program->count++;
+}
+
+/**
+ * @brief Emits `ast`; `tail` is set when nothing runs after it in its
+ * block.
+ */
+static void evaluator_compile_node(t_program *program, const t_ast *ast,
+                                   bool tail) {
+  size_t at;
+
+  switch (ast->type) {
+    case AST_LIST:
+      for (size_t i = 0; i < ast->list.count; ++i) {
+        evaluator_compile_node(program, ast->list.children[i],
+                               tail && i + 1 == ast->list.count);
+      }
+      break;
+
+    case AST_AND_OR:
+      // `&&` skips the next operand after a failure, `||` after a success;
+      // a skipped operand keeps the status of the last one that ran.
+      evaluator_compile_node(program, ast->and_or.children[0], false);
+      for (size_t i = 1; i < ast->and_or.count; ++i) {
+        at = evaluator_emit(program,
+                            ast->and_or.ops[i]->type == TOKEN_AND_IF
+                                ? EVALUATOR_OP_JUMP_IF_FAIL
+                                : EVALUATOR_OP_JUMP_IF_SUCCESS,
+                            false, NULL);
+        evaluator_compile_node(program, ast->and_or.children[i],
+                               tail && i + 1 == ast->and_or.count);
+        program->code[at].target = program->count;
+      }
+      break;
+
+    case AST_PIPE_SEQUENCE: {
+      size_t pipeline =
+          evaluator_emit(program, EVALUATOR_OP_PIPELINE, false, ast);
+      for (size_t i = 0; i < ast->pipe_sequence.count; ++i) {
+        const t_ast *stage = ast->pipe_sequence.children[i];
+        if (i + 1 < ast->pipe_sequence.count) {
+          evaluator_emit(program, EVALUATOR_OP_PIPE, false, NULL);
+        }
+        at = evaluator_emit(program, EVALUATOR_OP_SPAWN, false, stage);
+        evaluator_compile_node(program, stage, true);
+        evaluator_emit(program, EVALUATOR_OP_RETURN, true, NULL);
+        program->code[at].target = program->count;
+      }
+      program->code[pipeline].target = program->count;
+      evaluator_emit(program, EVALUATOR_OP_WAIT, tail, ast);
+      break;
+    }
+
+    case AST_SUBSHELL:
+      at = evaluator_emit(program, EVALUATOR_OP_SUBSHELL, tail, ast);
+      evaluator_compile_node(program, ast->subshell.list, true);
+      evaluator_emit(program, EVALUATOR_OP_RETURN, true, NULL);
+      program->code[at].target = program->count;
+      break;
+
+    case AST_BACKGROUND:
+      at = evaluator_emit(program, EVALUATOR_OP_BACKGROUND, tail,
+                          ast->background.command);
+      evaluator_compile_node(program, ast->background.command, true);
+      evaluator_emit(program, EVALUATOR_OP_RETURN, true, NULL);
+      program->code[at].target = program->count;
+      break;
+
+    case AST_SIMPLE_COMMAND:
+      evaluator_emit(program, EVALUATOR_OP_COMMAND, false, ast);
+      for (size_t i = 0; i < ast->simple_command.io_file_count; ++i) {
+        at = evaluator_emit(program, EVALUATOR_OP_REDIRECT, false, NULL);
+        program->code[at].io_file = &ast->simple_command.io_files[i];
+      }
+      evaluator_emit(program, EVALUATOR_OP_EXEC, tail, ast);
+      break;
+  }
+}
+
+static bool evaluator_is_jump(const t_instruction *instruction) {
+  return instruction->op == EVALUATOR_OP_JUMP_IF_FAIL ||
+         instruction->op == EVALUATOR_OP_JUMP_IF_SUCCESS;
+}
+
+/**
+ * @brief Threads conditional jumps through the ones they land on.
+ *
+ * The status does not change between them: in `a && b && c`, a failing `a`
+ * jumps straight past `c`, and in `a && b || c` straight to `c`.
+ */
+static void evaluator_thread_jumps(t_program *program) {
+  for (size_t i = program->count; i-- > 0;) {
+    t_instruction *jump = &program->code[i];
+    if (!evaluator_is_jump(jump)) continue;
+
+    // Jumps only go forward, so the ones after this one are threaded already
+    const t_instruction *next = &program->code[jump->target];
+    while (evaluator_is_jump(next)) {
+      jump->target = next->op == jump->op ? next->target : jump->target + 1;
+      next = &program->code[jump->target];
+    }
+  }
+}
+
+t_program *evaluator_compile(const t_ast *ast, t_arena *arena) {
+  t_program *program = arena_alloc(arena, sizeof(t_program));
+  size_t size = evaluator_compile_size(ast) + 1;
+
+  program->code = arena_alloc(arena, size * sizeof(t_instruction));
+  program->count = 0;
+  evaluator_compile_node(program, ast, true);
+  evaluator_emit(program, EVALUATOR_OP_RETURN, true, NULL);
+  evaluator_thread_jumps(program);
+  return program;
+}
+
+void evaluator_program_print(const t_program *program) {
+  static const char *names[] = {
+      [EVALUATOR_OP_COMMAND] = "COMMAND",
+      [EVALUATOR_OP_REDIRECT] = "REDIRECT",
+      [EVALUATOR_OP_EXEC] = "EXEC",
+      [EVALUATOR_OP_JUMP_IF_FAIL] = "JUMP_IF_FAIL",
+      [EVALUATOR_OP_JUMP_IF_SUCCESS] = "JUMP_IF_SUCCESS",
+      [EVALUATOR_OP_PIPELINE] = "PIPELINE",
+      [EVALUATOR_OP_PIPE] = "PIPE",
+      [EVALUATOR_OP_SPAWN] = "SPAWN",
+      [EVALUATOR_OP_WAIT] = "WAIT",
+      [EVALUATOR_OP_SUBSHELL] = "SUBSHELL",
+      [EVALUATOR_OP_BACKGROUND] = "BACKGROUND",
+      [EVALUATOR_OP_RETURN] = "RETURN",
+  };
+
+  for (size_t i = 0; i < program->count; ++i) {
+    const t_instruction *instruction = &program->code[i];
+    printf("%4zu  %-16s", i, names[instruction->op]);
+    switch (instruction->op) {
+      case EVALUATOR_OP_COMMAND:
+        if (instruction->node->simple_command.argc > 0) {
+          printf("%s", instruction->node->simple_command.argv[0]);
+        }
+        break;
+      case EVALUATOR_OP_REDIRECT:
+        printf("%s %s", instruction->io_file->op->literal,
+               instruction->io_file->filename);
+        break;
+      case EVALUATOR_OP_JUMP_IF_FAIL:
+      case EVALUATOR_OP_JUMP_IF_SUCCESS:
+      case EVALUATOR_OP_PIPELINE:
+      case EVALUATOR_OP_SPAWN:
+      case EVALUATOR_OP_SUBSHELL:
+      case EVALUATOR_OP_BACKGROUND:
+        printf("-> %u", (unsigned)instruction->target);
+        break;
+      default:
+        break;
+    }
+    printf("%s\n", instruction->tail ? "  (tail)" : "");
+  }
+}
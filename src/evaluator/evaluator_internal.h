@@ -2,40 +2,184 @@
 #define EVALUATOR_INTERNAL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <unistd.h>
 
+#include "arena/arena.h"
 #include "ast/ast.h"
 #include "environment/environment.h"
+#include "evaluator.h"
+#include "reaper/reaper.h"
 
-typedef struct s_io_context {
+/**
+ * @brief The evaluation state shared by all instructions.
+ *
+ * `exec_in_place` is set in a disposable child process; the external command
+ * of a `tail` instruction then replaces the process instead of forking
+ * again.
+ */
+typedef struct s_evaluator {
+  t_environment *environment;
+  t_arena *arena;
+  bool exec_in_place;
+} t_evaluator;
+
+/**
+ * @brief What one stage of a timed pipeline used.
+ *
+ * A stage running in the shell itself is charged the shell's own usage
+ * while it ran; its maximum resident set size is the shell's.
+ */
+typedef struct s_evaluator_timing {
+  struct timespec started;
+  t_reaper_usage usage;
+} t_evaluator_timing;
+
+/**
+ * @brief The operations of a compiled program.
+ *
+ * - `COMMAND` expands the words of a simple command, `REDIRECT` applies one
+ *   of its redirections, and `EXEC` runs it, unless one of them failed.
+ * - `JUMP_IF_FAIL` and `JUMP_IF_SUCCESS` skip to `target` after a failure
+ *   or a success, for `&&` and `||`.
+ * - `PIPELINE` starts a pipeline, `PIPE` creates the pipe to the next
+ *   stage, `SPAWN` starts a stage and `WAIT` waits for all of them.
+ * - `SUBSHELL` and `BACKGROUND` fork a process for their block.
+ * - `RETURN` ends the program or the block being run.
+ *
+ * A stage, subshell or background job is followed by its block, which ends
+ * with `RETURN`; `target` is the instruction after it.
+ */
+typedef enum e_evaluator_op {
+  EVALUATOR_OP_COMMAND,
+  EVALUATOR_OP_REDIRECT,
+  EVALUATOR_OP_EXEC,
+  EVALUATOR_OP_JUMP_IF_FAIL,
+  EVALUATOR_OP_JUMP_IF_SUCCESS,
+  EVALUATOR_OP_PIPELINE,
+  EVALUATOR_OP_PIPE,
+  EVALUATOR_OP_SPAWN,
+  EVALUATOR_OP_WAIT,
+  EVALUATOR_OP_SUBSHELL,
+  EVALUATOR_OP_BACKGROUND,
+  EVALUATOR_OP_RETURN,
+} t_evaluator_op;
+
+/**
+ * @brief One instruction of a compiled program.
+ *
+ * `tail` marks an instruction nothing runs after in its block. `node` is
+ * the simple command, pipeline, stage or job the instruction works on, and
+ * `io_file` the redirection of a `REDIRECT`.
+ */
+typedef struct s_instruction {
+  uint8_t op;
+  bool tail;
+  uint32_t target;
+  union {
+    const t_ast *node;
+    const t_io_file *io_file;
+  };
+} t_instruction;
+
+/**
+ * @brief A program compiled from a tree, which it still points into.
+ */
+struct s_program {
+  t_instruction *code;
+  size_t count;
+};
+
+/**
+ * @brief The state of the pipeline being started, from `PIPELINE` to
+ * `WAIT`.
+ *
+ * Stages that run in the shell are `deferred` until the others run; `blocks`
+ * holds where their code starts. `wait` is where a pipeline that could not
+ * be started in full jumps to.
+ */
+typedef struct s_evaluator_pipeline {
+  const t_ast *ast;
+  size_t count;
+  size_t started;
+  size_t wait;
+  pid_t *pids;
+  int *statuses;
+  t_io_context *deferred;
+  size_t *blocks;
+  int *held_fds;
+  size_t held_count;
   int in_fd;
-  int out_fd;
-  bool needs_close_in;
-  bool needs_close_out;
-} t_io_context;
-
-// Node evaluators
-int evaluator_list(t_ast *ast, t_hashmap *environment, t_io_context io);
-int evaluator_and_or(t_ast *ast, t_hashmap *environment, t_io_context io);
-int evaluator_pipe_sequence(t_ast *ast, t_hashmap *environment,
-                            t_io_context io);
-int evaluator_subshell(t_ast *ast, t_hashmap *environment, t_io_context io);
-int evaluator_simple_command(t_ast *ast, t_hashmap *environment,
-                             t_io_context io);
+  int pipe_fds[2];
+  t_io_context io;
+  t_evaluator_timing *timings;
+} t_evaluator_pipeline;
+
+// Program execution
+int evaluator_execute(const t_program *program, size_t pc,
+                      t_evaluator *evaluator, t_io_context io);
+int evaluator_exec_command(const char **argv, size_t argc,
+                           t_evaluator *evaluator, t_io_context io,
+                           bool in_place);
+void evaluator_pipeline_begin(t_evaluator_pipeline *pipeline,
+                              const t_instruction *instruction,
+                              t_evaluator *evaluator, t_io_context io);
+bool evaluator_pipeline_pipe(t_evaluator_pipeline *pipeline);
+bool evaluator_pipeline_spawn(t_evaluator_pipeline *pipeline,
+                              const t_program *program, size_t block,
+                              t_evaluator *evaluator);
+int evaluator_pipeline_wait(t_evaluator_pipeline *pipeline,
+                            const t_program *program,
+                            t_evaluator *evaluator);
+pid_t evaluator_start_stage(const t_program *program, size_t block,
+                            t_evaluator *evaluator, t_io_context io,
+                            const int *held_fds, size_t held_count,
+                            int *status);
+bool evaluator_runs_in_shell(const t_ast *ast);
+int evaluator_run_in_shell(const t_program *program, size_t block,
+                           t_evaluator *evaluator, t_io_context io);
+int evaluator_subshell(const t_program *program, size_t block, bool tail,
+                       t_evaluator *evaluator, t_io_context io);
+int evaluator_background(const t_program *program, size_t block,
+                         t_evaluator *evaluator, t_io_context io);
+const char **evaluator_expand_argv(const t_ast *ast, t_evaluator *evaluator,
+                                   size_t *argc);
 
 // IO redirection
-t_io_context evaluator_apply_io_file(t_ast *io_file, t_io_context io);
+bool evaluator_apply_io_file(const t_io_file *io_file, t_evaluator *evaluator,
+                             t_io_context *io);
 void evaluator_close_io(t_io_context *io);
 
 // Command handling
 bool evaluator_is_builtin(const char *cmd_name);
-int evaluator_execute_builtin(t_ast *ast, t_hashmap *environment,
+int evaluator_execute_builtin(const char **argv, t_evaluator *evaluator,
                               t_io_context io);
-int evaluator_execute_external(t_ast *ast, t_hashmap *environment,
+int evaluator_execute_external(const char **argv, t_evaluator *evaluator,
                                t_io_context io);
+pid_t evaluator_start_external(const char **argv, t_evaluator *evaluator,
+                               t_io_context io, int *status);
+int evaluator_replace_process(const char **argv, t_evaluator *evaluator,
+                              t_io_context io);
+
+// Process creation
+pid_t evaluator_spawn(const char *path, char **argv, char **envp,
+                      t_io_context io);
+pid_t evaluator_fork_exec(const char *path, char **argv, char **envp,
+                          t_io_context io);
+void evaluator_exec(const char *path, char **argv, char **envp,
+                    t_io_context io);
+int evaluator_pipe(int pipe_fds[2]);
+bool evaluator_is_exec_error(int error);
+int evaluator_exec_error(const char *path, int error);
+int evaluator_wait(pid_t pid, t_reaper_usage *usage);
 
-// Helper functions
-char **evaluator_build_argv(t_ast *cmd);
-char **evaluator_build_envp(t_hashmap *environment);
+// Timed pipelines
+void evaluator_time_start(t_evaluator_timing *timing);
+int evaluator_time_in_shell(const t_program *program, size_t block,
+                            t_evaluator *evaluator, t_io_context io,
+                            t_evaluator_timing *timing);
+void evaluator_time_report(const t_ast *ast, const t_evaluator_timing *timings,
+                           const int *statuses, size_t count);
 
 #endif
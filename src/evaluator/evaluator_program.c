@@ -0,0 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+
+#include "evaluator.h"
+#include "evaluator_internal.h"
+
+/**
+ * @brief Runs `program` from `pc` up to the `RETURN` ending its block, with
+ * `io` as the standard streams of the block.
+ *
+ * The simple command being built and the pipeline being started are kept
+ * here between the instructions that make them up.
+ */
+int evaluator_execute(const t_program *program, size_t pc,
+                      t_evaluator *evaluator, t_io_context io) {
+  t_environment *environment = evaluator->environment;
+  t_evaluator_pipeline pipeline;
+  const char **argv = NULL;
+  size_t argc = 0;
+  t_io_context command_io = io;
+  bool redirected = true;
+  int status = EXIT_SUCCESS;
+
+  for (;;) {
+    const t_instruction *instruction = &program->code[pc++];
+
+    switch ((t_evaluator_op)instruction->op) {
+      case EVALUATOR_OP_COMMAND:
+        argc = instruction->node->simple_command.argc;
+        argv = evaluator_expand_argv(instruction->node, evaluator, &argc);
+        command_io = io;
+        redirected = true;
+        break;
+
+      case EVALUATOR_OP_REDIRECT:
+        // Applied in the order they were written, up to the first failure
+        if (redirected) {
+          redirected = evaluator_apply_io_file(instruction->io_file,
+                                               evaluator, &command_io);
+        }
+        break;
+
+      case EVALUATOR_OP_EXEC:
+        // `$?` follows every command as soon as it completes
+        if (redirected) {
+          status = evaluator_exec_command(
+              argv, argc, evaluator, command_io,
+              evaluator->exec_in_place && instruction->tail);
+        } else {
+          evaluator_close_io(&command_io);
+          status = EXIT_FAILURE;
+        }
+        environment->status = status;
+        break;
+
+      case EVALUATOR_OP_JUMP_IF_FAIL:
+        if (status != EXIT_SUCCESS) pc = instruction->target;
+        break;
+
+      case EVALUATOR_OP_JUMP_IF_SUCCESS:
+        if (status == EXIT_SUCCESS) pc = instruction->target;
+        break;
+
+      case EVALUATOR_OP_PIPELINE:
+        evaluator_pipeline_begin(&pipeline, instruction, evaluator, io);
+        break;
+
+      case EVALUATOR_OP_PIPE:
+        if (!evaluator_pipeline_pipe(&pipeline)) pc = pipeline.wait;
+        break;
+
+      case EVALUATOR_OP_SPAWN:
+        pc = evaluator_pipeline_spawn(&pipeline, program, pc, evaluator)
+                 ? instruction->target
+                 : pipeline.wait;
+        break;
+
+      case EVALUATOR_OP_WAIT:
+        status = evaluator_pipeline_wait(&pipeline, program, evaluator);
+        environment->status = status;
+        break;
+
+      case EVALUATOR_OP_SUBSHELL:
+        status = evaluator_subshell(program, pc, instruction->tail, evaluator,
+                                    io);
+        environment->status = status;
+        pc = instruction->target;
+        break;
+
+      case EVALUATOR_OP_BACKGROUND:
+        status = evaluator_background(program, pc, evaluator, io);
+        environment->status = status;
+        pc = instruction->target;
+        break;
+
+      case EVALUATOR_OP_RETURN:
+        return status;
+    }
+  }
+}
@@ -0,0 +1,135 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "evaluator_internal.h"
+#include "minishell.h"
+#include "reaper/reaper.h"
+
+pid_t evaluator_launch(const char *path, char **argv, char **envp,
+                       t_io_context io) {
+  // Spawn without duplicating the shell's address space; a plain fork() is
+  // only used when the spawn machinery itself fails, not the executable.
+  pid_t pid = evaluator_spawn(path, argv, envp, io);
+  if (pid == -1 && !evaluator_is_exec_error(errno)) {
+    pid = evaluator_fork_exec(path, argv, envp, io);
+  }
+  if (pid != -1) reaper_watch(pid);
+  return pid;
+}
+
+pid_t evaluator_spawn(const char *path, char **argv, char **envp,
+                      t_io_context io) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  sigset_t defaults;
+  pid_t pid;
+
+  posix_spawn_file_actions_init(&actions);
+  if (io.in_fd != STDIN_FILENO) {
+    posix_spawn_file_actions_adddup2(&actions, io.in_fd, STDIN_FILENO);
+    posix_spawn_file_actions_addclose(&actions, io.in_fd);
+  }
+  if (io.out_fd != STDOUT_FILENO) {
+    posix_spawn_file_actions_adddup2(&actions, io.out_fd, STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, io.out_fd);
+  }
+
+  // The REPL ignores SIGQUIT; commands must get the default dispositions back
+  posix_spawnattr_init(&attr);
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGINT);
+  sigaddset(&defaults, SIGQUIT);
+  posix_spawnattr_setsigdefault(&attr, &defaults);
+  posix_spawnattr_setsigmask(&attr, reaper_exec_mask());
+  posix_spawnattr_setflags(&attr,
+                           POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+  int error = posix_spawn(&pid, path, &actions, &attr, argv, envp);
+
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (error) {
+    errno = error;
+    return -1;
+  }
+  return pid;
+}
+
+pid_t evaluator_fork_exec(const char *path, char **argv, char **envp,
+                          t_io_context io) {
+  pid_t pid = fork();
+
+  if (pid != 0) return pid;
+
+  evaluator_exec(path, argv, envp, io);
+  _exit(evaluator_exec_error(argv[0], errno));
+}
+
+void evaluator_exec(const char *path, char **argv, char **envp,
+                    t_io_context io) {
+  if (io.in_fd != STDIN_FILENO && dup2(io.in_fd, STDIN_FILENO) == -1) {
+    perror(MINISHELL_NAME);
+    _exit(EXIT_FAILURE);
+  }
+  if (io.out_fd != STDOUT_FILENO && dup2(io.out_fd, STDOUT_FILENO) == -1) {
+    perror(MINISHELL_NAME);
+    _exit(EXIT_FAILURE);
+  }
+  evaluator_close_io(&io);
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGQUIT, SIG_DFL);
+  sigprocmask(SIG_SETMASK, reaper_exec_mask(), NULL);
+  execve(path, argv, envp);
+}
+
+int evaluator_pipe(int pipe_fds[2]) {
+  // Both ends are close-on-exec: a spawned stage must not keep a copy of a
+  // pipe it does not use, or its reader would never see end-of-file.
+  if (pipe(pipe_fds) == -1) return -1;
+  fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+  return 0;
+}
+
+bool evaluator_is_exec_error(int error) {
+  return error == ENOENT || error == EACCES || error == ENOEXEC ||
+         error == ENOTDIR || error == ELOOP || error == ENAMETOOLONG ||
+         error == E2BIG || error == ETXTBSY || error == EISDIR;
+}
+
+int evaluator_exec_error(const char *path, int error) {
+  if (error == ENOENT) {
+    fprintf(stderr, "%s: command not found: %s\n", MINISHELL_NAME, path);
+    return EVALUATOR_STATUS_NOT_FOUND;
+  }
+
+  fprintf(stderr, "%s: %s: %s\n", MINISHELL_NAME, path, strerror(error));
+  return evaluator_is_exec_error(error) ? EVALUATOR_STATUS_NOT_EXECUTABLE
+                                        : EXIT_FAILURE;
+}
+
+int evaluator_wait(pid_t pid, t_reaper_usage *usage) {
+  int wait_status = reaper_wait(pid, usage);
+
+  if (wait_status == -1) return EXIT_FAILURE;
+  return evaluator_status(wait_status);
+}
+
+int evaluator_status(int wait_status) {
+  if (WIFEXITED(wait_status)) return WEXITSTATUS(wait_status);
+  if (WIFSIGNALED(wait_status)) {
+    return EVALUATOR_STATUS_SIGNALED + WTERMSIG(wait_status);
+  }
+  return EXIT_FAILURE;
+}
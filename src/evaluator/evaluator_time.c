@@ -0,0 +1,211 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "evaluator_internal.h"
+#include "writer/writer.h"
+
+/**
+ * @brief Totals of a timed pipeline, or of one of its stages, in the units
+ * they are reported in.
+ */
+typedef struct s_evaluator_times {
+  double real;
+  double user;
+  double sys;
+  long max_rss;
+  long voluntary_switches;
+  long involuntary_switches;
+} t_evaluator_times;
+
+void evaluator_time_start(t_evaluator_timing *timing) {
+  clock_gettime(CLOCK_MONOTONIC, &timing->started);
+  memset(&timing->usage.rusage, 0, sizeof(timing->usage.rusage));
+
+  // A stage that never gets a process is over as soon as it starts
+  timing->usage.exited_at = timing->started;
+}
+
+static double evaluator_time_seconds(struct timeval time) {
+  return (double)time.tv_sec + (double)time.tv_usec / 1e6;
+}
+
+static double evaluator_time_elapsed(struct timespec from,
+                                     struct timespec to) {
+  return (double)(to.tv_sec - from.tv_sec) +
+         (double)(to.tv_nsec - from.tv_nsec) / 1e9;
+}
+
+int evaluator_time_in_shell(const t_program *program, size_t block,
+                            t_evaluator *evaluator, t_io_context io,
+                            t_evaluator_timing *timing) {
+  struct rusage before;
+  struct rusage *after = &timing->usage.rusage;
+
+  evaluator_time_start(timing);
+  getrusage(RUSAGE_SELF, &before);
+  int status = evaluator_run_in_shell(program, block, evaluator, io);
+  getrusage(RUSAGE_SELF, after);
+  clock_gettime(CLOCK_MONOTONIC, &timing->usage.exited_at);
+
+  // Charge the stage the difference only; the peak is the shell's own
+  after->ru_utime.tv_sec -= before.ru_utime.tv_sec;
+  after->ru_utime.tv_usec -= before.ru_utime.tv_usec;
+  after->ru_stime.tv_sec -= before.ru_stime.tv_sec;
+  after->ru_stime.tv_usec -= before.ru_stime.tv_usec;
+  after->ru_nvcsw -= before.ru_nvcsw;
+  after->ru_nivcsw -= before.ru_nivcsw;
+  return status;
+}
+
+static t_evaluator_times evaluator_time_stage(
+    const t_evaluator_timing *timing) {
+  const struct rusage *rusage = &timing->usage.rusage;
+
+  return (t_evaluator_times){
+      .real = evaluator_time_elapsed(timing->started, timing->usage.exited_at),
+      .user = evaluator_time_seconds(rusage->ru_utime),
+      .sys = evaluator_time_seconds(rusage->ru_stime),
+      .max_rss = rusage->ru_maxrss,
+      .voluntary_switches = rusage->ru_nvcsw,
+      .involuntary_switches = rusage->ru_nivcsw,
+  };
+}
+
+/**
+ * @brief Adds up the stages; the pipeline runs from the first start to the
+ * last exit, and its peak is the largest of the stages.
+ */
+static t_evaluator_times evaluator_time_total(
+    const t_evaluator_timing *timings, size_t count) {
+  t_evaluator_times total = {0};
+  struct timespec first = timings[0].started;
+  struct timespec last = timings[0].usage.exited_at;
+
+  for (size_t i = 0; i < count; ++i) {
+    t_evaluator_times stage = evaluator_time_stage(&timings[i]);
+    if (evaluator_time_elapsed(timings[i].started, first) > 0) {
+      first = timings[i].started;
+    }
+    if (evaluator_time_elapsed(last, timings[i].usage.exited_at) > 0) {
+      last = timings[i].usage.exited_at;
+    }
+    total.user += stage.user;
+    total.sys += stage.sys;
+    if (stage.max_rss > total.max_rss) total.max_rss = stage.max_rss;
+    total.voluntary_switches += stage.voluntary_switches;
+    total.involuntary_switches += stage.involuntary_switches;
+  }
+  total.real = evaluator_time_elapsed(first, last);
+  return total;
+}
+
+static const char *evaluator_time_name(const t_ast *stage) {
+  if (stage->type != AST_SIMPLE_COMMAND) return ast_type_to_string(stage->type);
+  if (stage->simple_command.argc == 0) return "";
+  return stage->simple_command.argv[0];
+}
+
+static void evaluator_time_text_row(t_writer *writer, const char *label,
+                                    const t_evaluator_times *times,
+                                    const char *name) {
+  char line[128];
+
+  snprintf(line, sizeof(line), "%-6s %9.3f %9.3f %9.3f %10ld %8ld %8ld",
+           label, times->real, times->user, times->sys, times->max_rss,
+           times->voluntary_switches, times->involuntary_switches);
+  writer_puts(writer, line);
+  if (*name) {
+    writer_puts(writer, "  ");
+    writer_puts(writer, name);
+  }
+  writer_putc(writer, '\n');
+}
+
+static void evaluator_time_text(t_writer *writer, const t_ast *ast,
+                                const t_evaluator_timing *timings,
+                                size_t count) {
+  char label[24];
+
+  writer_puts(writer, "stage       real      user       sys  maxrss_kb"
+                      "     vcsw    ivcsw  command\n");
+  for (size_t i = 0; i < count; ++i) {
+    t_evaluator_times stage = evaluator_time_stage(&timings[i]);
+    const char *name = evaluator_time_name(ast->pipe_sequence.children[i]);
+    snprintf(label, sizeof(label), "%zu", i + 1);
+    evaluator_time_text_row(writer, label, &stage, name);
+  }
+
+  t_evaluator_times total = evaluator_time_total(timings, count);
+  evaluator_time_text_row(writer, "total", &total, "");
+}
+
+static void evaluator_time_json_string(t_writer *writer, const char *str) {
+  char escape[8];
+
+  writer_putc(writer, '"');
+  for (; *str; ++str) {
+    unsigned char c = *str;
+    if (c == '"' || c == '\\') {
+      writer_putc(writer, '\\');
+      writer_putc(writer, c);
+    } else if (c < 0x20) {
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      writer_puts(writer, escape);
+    } else {
+      writer_putc(writer, c);
+    }
+  }
+  writer_putc(writer, '"');
+}
+
+static void evaluator_time_json_fields(t_writer *writer, int status,
+                                       const t_evaluator_times *times) {
+  char fields[256];
+
+  snprintf(fields, sizeof(fields),
+           "\"status\":%d,\"real\":%.6f,\"user\":%.6f,\"sys\":%.6f,"
+           "\"maxrss_kb\":%ld,\"voluntary_switches\":%ld,"
+           "\"involuntary_switches\":%ld",
+           status, times->real, times->user, times->sys, times->max_rss,
+           times->voluntary_switches, times->involuntary_switches);
+  writer_puts(writer, fields);
+}
+
+static void evaluator_time_json(t_writer *writer, const t_ast *ast,
+                                const t_evaluator_timing *timings,
+                                const int *statuses, size_t count) {
+  t_evaluator_times total = evaluator_time_total(timings, count);
+
+  writer_putc(writer, '{');
+  evaluator_time_json_fields(writer, statuses[count - 1], &total);
+  writer_puts(writer, ",\"stages\":[");
+  for (size_t i = 0; i < count; ++i) {
+    t_evaluator_times stage = evaluator_time_stage(&timings[i]);
+    writer_puts(writer, i > 0 ? ",{\"command\":" : "{\"command\":");
+    evaluator_time_json_string(
+        writer, evaluator_time_name(ast->pipe_sequence.children[i]));
+    writer_putc(writer, ',');
+    evaluator_time_json_fields(writer, statuses[i], &stage);
+    writer_putc(writer, '}');
+  }
+  writer_puts(writer, "]}\n");
+}
+
+void evaluator_time_report(const t_ast *ast, const t_evaluator_timing *timings,
+                           const int *statuses, size_t count) {
+  t_writer writer;
+
+  if (count == 0) return;
+  writer_init(&writer, STDERR_FILENO);
+  if (ast->pipe_sequence.timing == AST_TIMING_JSON) {
+    evaluator_time_json(&writer, ast, timings, statuses, count);
+  } else {
+    evaluator_time_text(&writer, ast, timings, count);
+  }
+  writer_flush(&writer);
+}
@@ -0,0 +1,238 @@
+#include "expander.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "glob/glob.h"
+#include "job/job.h"
+#include "lexer/lexer.h"
+
+/**
+ * @brief Looks up the value of the parameter named by `segment`.
+ *
+ * @return Its value, or an empty string if it is not set.
+ */
+static const char *expander_parameter(const t_word_segment *segment,
+                                      const t_environment *environment,
+                                      t_arena *arena) {
+  char buffer[EXPANDER_NAME_SIZE];
+  char *name = buffer;
+
+  // Names are not terminated in the lexer buffer
+  if (segment->length >= sizeof(buffer)) {
+    name = arena_alloc(arena, segment->length + 1);
+  }
+  memcpy(name, segment->text, segment->length);
+  name[segment->length] = '\0';
+
+  const char *value = environment_get(environment, name);
+  return value ? value : "";
+}
+
+/**
+ * @brief Resolves `segment`, which is not literal, to the text it stands
+ * for.
+ */
+static const char *expander_segment(const t_word_segment *segment,
+                                    const t_environment *environment,
+                                    t_arena *arena) {
+  if (segment->type == WORD_SEGMENT_PARAMETER) {
+    return expander_parameter(segment, environment, arena);
+  }
+
+  char *number = arena_alloc(arena, EXPANDER_NUMBER_SIZE);
+  switch (segment->type) {
+    case WORD_SEGMENT_STATUS:
+      snprintf(number, EXPANDER_NUMBER_SIZE, "%d", environment->status);
+      return number;
+    case WORD_SEGMENT_SHELL_PID:
+      snprintf(number, EXPANDER_NUMBER_SIZE, "%ld",
+               (long)environment->shell_pid);
+      return number;
+    case WORD_SEGMENT_LAST_PID:
+      // Unset until a background command was started
+      if (job_last_pid() == 0) return "";
+      snprintf(number, EXPANDER_NUMBER_SIZE, "%ld", (long)job_last_pid());
+      return number;
+    default:
+      return "";
+  }
+}
+
+/**
+ * @brief Whether `segment` is used as written: literal text, or a pattern
+ * character outside of pathname expansion.
+ */
+static bool expander_is_text(const t_word_segment *segment) {
+  return segment->type == WORD_SEGMENT_LITERAL ||
+         segment->type == WORD_SEGMENT_ANY_STRING ||
+         segment->type == WORD_SEGMENT_ANY_CHAR ||
+         segment->type == WORD_SEGMENT_BRACKET;
+}
+
+const char *expander_word(const t_word_expansion *expansion,
+                          const t_environment *environment, t_arena *arena) {
+  const char **values = arena_alloc(arena, expansion->count * sizeof(char *));
+  size_t *lengths = arena_alloc(arena, expansion->count * sizeof(size_t));
+  size_t length = 0;
+
+  for (size_t i = 0; i < expansion->count; ++i) {
+    const t_word_segment *segment = &expansion->segments[i];
+    if (expander_is_text(segment)) {
+      values[i] = segment->text;
+      lengths[i] = segment->length;
+    } else {
+      values[i] = expander_segment(segment, environment, arena);
+      lengths[i] = strlen(values[i]);
+    }
+    length += lengths[i];
+  }
+
+  char *word = arena_alloc(arena, length + 1);
+  char *end = word;
+  for (size_t i = 0; i < expansion->count; ++i) {
+    memcpy(end, values[i], lengths[i]);
+    end += lengths[i];
+  }
+  *end = '\0';
+  return word;
+}
+
+/**
+ * @brief Matches the pattern `expansion` spells against the filesystem.
+ *
+ * Parameter values are matched literally: only pattern characters written
+ * in the word itself are special.
+ */
+static const char **expander_glob(const t_word_expansion *expansion,
+                                  const t_environment *environment,
+                                  t_arena *arena, t_glob_cache *cache,
+                                  size_t *count) {
+  t_word_segment *pattern =
+      arena_alloc(arena, expansion->count * sizeof(t_word_segment));
+
+  for (size_t i = 0; i < expansion->count; ++i) {
+    pattern[i] = expansion->segments[i];
+    if (!expander_is_text(&pattern[i])) {
+      const char *value = expander_segment(&pattern[i], environment, arena);
+      pattern[i] = (t_word_segment){
+          .type = WORD_SEGMENT_LITERAL,
+          .text = value,
+          .length = strlen(value),
+      };
+    }
+  }
+  return glob_expand(cache, pattern, expansion->count, count);
+}
+
+/**
+ * @brief Appends `word` to the arguments, growing them in the arena.
+ */
+static void expander_push(t_expander_words *words, const char *word,
+                          t_arena *arena) {
+  if (words->count == words->capacity) {
+    words->capacity *= 2;
+    const char **items = arena_alloc(arena, words->capacity * sizeof(char *));
+    memcpy(items, words->items, words->count * sizeof(char *));
+    words->items = items;
+  }
+  words->items[words->count++] = word;
+}
+
+const char **expander_argv(const char **argv,
+                           const t_word_expansion **expansions, size_t *argc,
+                           const t_environment *environment, t_arena *arena) {
+  if (!expansions) return argv;
+
+  t_expander_words words = {
+      .items = arena_alloc(arena, (*argc + 1) * sizeof(char *)),
+      .count = 0,
+      .capacity = *argc + 1,
+  };
+  t_glob_cache *cache = NULL;
+
+  for (size_t i = 0; i < *argc; ++i) {
+    const t_word_expansion *expansion = expansions[i];
+    size_t count = 0;
+
+    if (!expansion) {
+      expander_push(&words, argv[i], arena);
+      continue;
+    }
+
+    // The words of one command share their directory listings
+    if (expansion->glob) {
+      if (!cache) cache = glob_cache_new(arena);
+      const char **paths =
+          expander_glob(expansion, environment, arena, cache, &count);
+      for (size_t k = 0; k < count; ++k) {
+        expander_push(&words, paths[k], arena);
+      }
+    }
+
+    // A pattern that matches nothing is kept as written
+    if (count == 0) {
+      const char *word = expander_word(expansion, environment, arena);
+      if (*word || expansion->quoted) expander_push(&words, word, arena);
+    }
+  }
+
+  expander_push(&words, NULL, arena);
+  *argc = words.count - 1;
+  return words.items;
+}
+
+const char *expander_heredoc_line(const char *line, size_t *length,
+                                  const t_environment *environment,
+                                  t_arena *arena) {
+  size_t dollars = 0;
+
+  for (size_t i = 0; i < *length; ++i) dollars += line[i] == '$';
+  if (dollars == 0 && !memchr(line, '\\', *length)) return line;
+
+  // At most one literal segment sits before and after each expansion, and
+  // unescaping only ever shortens them
+  char *text = arena_alloc(arena, *length);
+  t_word_segment *segments =
+      arena_alloc(arena, (2 * dollars + 1) * sizeof(t_word_segment));
+  t_word_expansion expansion = {.segments = segments, .count = 0};
+  size_t written = 0;
+  size_t literal_start = 0;
+
+  for (size_t i = 0; i < *length;) {
+    t_word_segment segment;
+    size_t expanded;
+
+    if (line[i] == '\\' && i + 1 < *length &&
+        strchr(EXPANDER_HEREDOC_ESCAPES, line[i + 1])) {
+      text[written++] = line[i + 1];
+      i += 2;
+    } else if (line[i] == '$' &&
+               (expanded = lexer_expansion(line, *length, i, &segment))) {
+      if (written > literal_start) {
+        segments[expansion.count++] = (t_word_segment){
+            .type = WORD_SEGMENT_LITERAL,
+            .text = text + literal_start,
+            .length = written - literal_start,
+        };
+      }
+      segments[expansion.count++] = segment;
+      literal_start = written;
+      i += expanded;
+    } else {
+      text[written++] = line[i++];
+    }
+  }
+  if (written > literal_start) {
+    segments[expansion.count++] = (t_word_segment){
+        .type = WORD_SEGMENT_LITERAL,
+        .text = text + literal_start,
+        .length = written - literal_start,
+    };
+  }
+
+  const char *expanded = expander_word(&expansion, environment, arena);
+  *length = strlen(expanded);
+  return expanded;
+}
@@ -0,0 +1,80 @@
+#ifndef EXPANDER_H
+#define EXPANDER_H
+
+#include <stddef.h>
+
+#include "arena/arena.h"
+#include "environment/environment.h"
+#include "token/token.h"
+
+/**
+ * @brief Size of the stack buffer parameter names are looked up from;
+ * longer names are copied to the arena.
+ */
+#define EXPANDER_NAME_SIZE 64
+
+/**
+ * @brief Room for the decimal value of `$?`, `$$` or `$!`.
+ */
+#define EXPANDER_NUMBER_SIZE 24
+
+/**
+ * @brief The arguments of a command being expanded.
+ */
+typedef struct s_expander_words {
+  const char **items;
+  size_t count;
+  size_t capacity;
+} t_expander_words;
+
+/**
+ * @brief Assembles the word described by `expansion`, without pathname
+ * expansion.
+ *
+ * Every value is looked up once to size the result, which is then filled in
+ * a single pass. Words are not split on the values' blanks.
+ *
+ * @return The word, allocated from `arena`.
+ */
+const char *expander_word(const t_word_expansion *expansion,
+                          const t_environment *environment, t_arena *arena);
+
+/**
+ * @brief Expands the words of a command.
+ *
+ * A word with pattern characters is replaced by the sorted paths it
+ * matches, or kept as written when there are none; the words share one
+ * cache of directory listings.
+ *
+ * @param expansions The expansion of each word, as stored in the AST, or
+ * NULL when every word is used as written.
+ * @param argc The number of words; receives the number left once words that
+ * expanded to nothing are dropped.
+ * @return `argv` itself when there is nothing to expand, or a new
+ * NULL-terminated array allocated from `arena`.
+ */
+const char **expander_argv(const char **argv,
+                           const t_word_expansion **expansions, size_t *argc,
+                           const t_environment *environment, t_arena *arena);
+
+/**
+ * @brief Bytes a backslash escapes in a here-document body; before any other
+ * byte it stands for itself.
+ */
+#define EXPANDER_HEREDOC_ESCAPES "$`\\"
+
+/**
+ * @brief Expands the parameters of a line of a here-document body.
+ *
+ * Quotes are plain text there, and a backslash only escapes
+ * `EXPANDER_HEREDOC_ESCAPES`.
+ *
+ * @param length The length of `line`; receives the length of the result.
+ * @return `line` itself when there is nothing to expand, or the expanded
+ * line allocated from `arena`.
+ */
+const char *expander_heredoc_line(const char *line, size_t *length,
+                                  const t_environment *environment,
+                                  t_arena *arena);
+
+#endif
@@ -0,0 +1,113 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "glob.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "glob_internal.h"
+
+t_glob_cache *glob_cache_new(t_arena *arena) {
+  t_glob_cache *cache = arena_alloc(arena, sizeof(t_glob_cache));
+
+  *cache = (t_glob_cache){.arena = arena, .listings = NULL};
+  return cache;
+}
+
+static int glob_compare_paths(const void *a, const void *b) {
+  return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static void glob_push(t_glob *glob, const char *path) {
+  if (glob->count == glob->capacity) {
+    size_t capacity = glob->capacity ? glob->capacity * 2 : 16;
+    const char **paths =
+        arena_alloc(glob->cache->arena, capacity * sizeof(char *));
+    if (glob->count) memcpy(paths, glob->paths, glob->count * sizeof(char *));
+    glob->paths = paths;
+    glob->capacity = capacity;
+  }
+  glob->paths[glob->count++] = path;
+}
+
+/**
+ * @brief Appends `name`, and a slash unless it is the last component, to
+ * `path`.
+ */
+static char *glob_join(t_glob *glob, const char *path, const char *name,
+                       bool slash) {
+  size_t path_length = strlen(path);
+  size_t name_length = strlen(name);
+  char *joined =
+      arena_alloc(glob->cache->arena, path_length + name_length + 2);
+
+  memcpy(joined, path, path_length);
+  memcpy(joined + path_length, name, name_length);
+  joined[path_length + name_length] = '/';
+  joined[path_length + name_length + slash] = '\0';
+  return joined;
+}
+
+/**
+ * @brief Matches the components from `index` on below `path`.
+ *
+ * @param unchecked Whether `path` ends with literal components nobody
+ * checked the existence of yet.
+ */
+static void glob_walk(t_glob *glob, size_t index, const char *path,
+                      bool unchecked) {
+  struct stat status;
+
+  if (index == glob->component_count) {
+    if (!unchecked || lstat(path, &status) == 0) glob_push(glob, path);
+    return;
+  }
+
+  const t_glob_matcher *matcher = &glob->components[index];
+  bool last = index + 1 == glob->component_count;
+
+  if (matcher->strategy == GLOB_LITERAL) {
+    glob_walk(glob, index + 1, glob_join(glob, path, matcher->text, !last),
+              true);
+    return;
+  }
+
+  const t_glob_listing *listing = glob_list(glob->cache, path);
+  for (size_t i = 0; i < listing->count; ++i) {
+    const t_glob_dirent *entry = listing->entries[i];
+    if (entry->name[0] == '.' && !matcher->matches_dot) continue;
+    if (!glob_match(matcher, entry->name)) continue;
+
+    char *joined = glob_join(glob, path, entry->name, !last);
+    if (!last) {
+      // Checked without the trailing slash, which stat would follow
+      joined[strlen(joined) - 1] = '\0';
+      bool directory = glob_is_directory(joined, entry);
+      joined[strlen(joined)] = '/';
+      if (!directory) continue;
+    }
+    glob_walk(glob, index + 1, joined, false);
+  }
+}
+
+const char **glob_expand(t_glob_cache *cache, const t_word_segment *segments,
+                         size_t segment_count, size_t *count) {
+  t_glob glob = {.cache = cache, .paths = NULL, .count = 0, .capacity = 0};
+  size_t patterns = 0;
+
+  glob.component_count = glob_compile(&glob, segments, segment_count);
+  glob_walk(&glob, 0, "", false);
+
+  // Each listing is sorted, which orders the paths unless several
+  // components had to be listed
+  for (size_t i = 0; i < glob.component_count; ++i) {
+    patterns += glob.components[i].strategy != GLOB_LITERAL;
+  }
+  if (patterns > 1) {
+    qsort(glob.paths, glob.count, sizeof(char *), glob_compare_paths);
+  }
+
+  *count = glob.count;
+  return glob.paths;
+}
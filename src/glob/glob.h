@@ -0,0 +1,31 @@
+#ifndef GLOB_H
+#define GLOB_H
+
+#include <stddef.h>
+
+#include "arena/arena.h"
+#include "token/token.h"
+
+typedef struct s_glob_cache t_glob_cache;
+
+/**
+ * @brief Creates a cache of directory listings, allocated from `arena`.
+ *
+ * Every directory is read once per cache; a command's words share one, so
+ * `*.c *.h` lists the directory a single time.
+ */
+t_glob_cache *glob_cache_new(t_arena *arena);
+
+/**
+ * @brief Expands a pattern into the paths it matches.
+ *
+ * @param segments The pattern, made of literal segments and pattern
+ * characters only: parameters must be resolved to literals first.
+ * @param count Receives the number of paths.
+ * @return The paths in byte order, allocated from the cache's arena; `count`
+ * is 0 when nothing matches.
+ */
+const char **glob_expand(t_glob_cache *cache, const t_word_segment *segments,
+                         size_t segment_count, size_t *count);
+
+#endif
@@ -0,0 +1,112 @@
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ft_stdlib.h"
+#include "glob_internal.h"
+
+/**
+ * @brief A block of records returned by one `getdents64` call.
+ */
+typedef struct s_glob_batch {
+  const char *data;
+  size_t size;
+  struct s_glob_batch *next;
+} t_glob_batch;
+
+static int glob_compare_entries(const void *a, const void *b) {
+  return strcmp((*(const t_glob_dirent *const *)a)->name,
+                (*(const t_glob_dirent *const *)b)->name);
+}
+
+static bool glob_is_dot_or_dot_dot(const char *name) {
+  return name[0] == '.' &&
+         (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+/**
+ * @brief Reads the whole directory in large batches, keeping the records as
+ * the kernel wrote them.
+ *
+ * @return The batches in reverse order, with `count` set to the number of
+ * entries other than `.` and `..`.
+ */
+static t_glob_batch *glob_read(t_arena *arena, int fd, size_t *count) {
+  char *buffer = ft_expect(malloc(GLOB_GETDENTS_SIZE), __func__);
+  t_glob_batch *batches = NULL;
+  long size;
+
+  *count = 0;
+  while ((size = syscall(SYS_getdents64, fd, buffer, GLOB_GETDENTS_SIZE)) >
+         0) {
+    t_glob_batch *batch = arena_alloc(arena, sizeof(t_glob_batch));
+    *batch = (t_glob_batch){
+        .data = memcpy(arena_alloc(arena, size), buffer, size),
+        .size = size,
+        .next = batches,
+    };
+    batches = batch;
+    for (long offset = 0; offset < size;) {
+      const t_glob_dirent *entry = (const void *)(buffer + offset);
+      *count += !glob_is_dot_or_dot_dot(entry->name);
+      offset += entry->reclen;
+    }
+  }
+  free(buffer);
+  return batches;
+}
+
+const t_glob_listing *glob_list(t_glob_cache *cache, const char *path) {
+  for (t_glob_listing *listing = cache->listings; listing;
+       listing = listing->next) {
+    if (strcmp(listing->path, path) == 0) return listing;
+  }
+
+  t_glob_listing *listing = arena_alloc(cache->arena, sizeof(t_glob_listing));
+  *listing = (t_glob_listing){
+      .path = strcpy(arena_alloc(cache->arena, strlen(path) + 1), path),
+      .entries = NULL,
+      .count = 0,
+      .next = cache->listings,
+  };
+  cache->listings = listing;
+
+  // A directory that cannot be read simply has nothing to match
+  int fd = open(*path ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd == -1) return listing;
+  size_t count;
+  t_glob_batch *batches = glob_read(cache->arena, fd, &count);
+  close(fd);
+
+  const t_glob_dirent **entries =
+      arena_alloc(cache->arena, count * sizeof(t_glob_dirent *));
+  for (t_glob_batch *batch = batches; batch; batch = batch->next) {
+    for (size_t offset = 0; offset < batch->size;) {
+      const t_glob_dirent *entry = (const void *)(batch->data + offset);
+      if (!glob_is_dot_or_dot_dot(entry->name)) {
+        entries[listing->count++] = entry;
+      }
+      offset += entry->reclen;
+    }
+  }
+
+  // Sorted once here, so every pattern matched against the directory
+  // yields its names in order
+  qsort(entries, listing->count, sizeof(*entries), glob_compare_entries);
+  listing->entries = entries;
+  return listing;
+}
+
+bool glob_is_directory(const char *path, const t_glob_dirent *entry) {
+  struct stat status;
+
+  if (entry->type == DT_DIR) return true;
+  if (entry->type != DT_LNK && entry->type != DT_UNKNOWN) return false;
+  return stat(path, &status) == 0 && S_ISDIR(status.st_mode);
+}
@@ -0,0 +1,115 @@
+#ifndef GLOB_INTERNAL_H
+#define GLOB_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "glob.h"
+
+/**
+ * @brief Bytes read from a directory per `getdents64` call.
+ */
+#define GLOB_GETDENTS_SIZE (256 * 1024)
+
+/**
+ * @brief Bytes of a bracket expression's membership bitmap, a bit per byte
+ * value.
+ */
+#define GLOB_SET_SIZE 32
+
+typedef enum e_glob_atom_type {
+  GLOB_ATOM_CHAR,
+  GLOB_ATOM_ANY,
+  GLOB_ATOM_STAR,
+  GLOB_ATOM_SET,
+} t_glob_atom_type;
+
+/**
+ * @brief One position of a compiled pattern; `set` is the membership
+ * bitmap of a bracket expression.
+ */
+typedef struct s_glob_atom {
+  t_glob_atom_type type;
+  unsigned char c;
+  const unsigned char *set;
+} t_glob_atom;
+
+/**
+ * @brief How a component is matched, from the cheapest: a literal name, a
+ * fixed prefix or suffix around one `*`, or the general backtracking loop.
+ */
+typedef enum e_glob_strategy {
+  GLOB_LITERAL,
+  GLOB_PREFIX,
+  GLOB_SUFFIX,
+  GLOB_GENERAL,
+} t_glob_strategy;
+
+/**
+ * @brief A pathname component compiled once per expansion.
+ *
+ * `text` is the literal name, or the fixed part of a prefix or suffix
+ * pattern. A leading `.` must be matched explicitly, so `matches_dot` is
+ * set only when the pattern starts with one.
+ */
+typedef struct s_glob_matcher {
+  t_glob_strategy strategy;
+  const t_glob_atom *atoms;
+  size_t count;
+  char *text;
+  size_t length;
+  bool matches_dot;
+} t_glob_matcher;
+
+/**
+ * @brief A directory entry as `getdents64` lays it out.
+ */
+typedef struct s_glob_dirent {
+  uint64_t ino;
+  int64_t off;
+  unsigned short reclen;
+  unsigned char type;
+  char name[];
+} t_glob_dirent;
+
+/**
+ * @brief The entries of a directory, sorted by name; `count` is 0 when it
+ * could not be read.
+ */
+typedef struct s_glob_listing {
+  const char *path;
+  const t_glob_dirent **entries;
+  size_t count;
+  struct s_glob_listing *next;
+} t_glob_listing;
+
+struct s_glob_cache {
+  t_arena *arena;
+  t_glob_listing *listings;
+};
+
+/**
+ * @brief The state of one expansion: its compiled components and the paths
+ * found so far.
+ */
+typedef struct s_glob {
+  t_glob_cache *cache;
+  t_glob_matcher *components;
+  size_t component_count;
+  const char **paths;
+  size_t count;
+  size_t capacity;
+} t_glob;
+
+// Matching
+size_t glob_compile(t_glob *glob, const t_word_segment *segments,
+                    size_t segment_count);
+bool glob_match(const t_glob_matcher *matcher, const char *name);
+bool glob_match_atoms(const t_glob_atom *atoms, size_t count,
+                      const char *name);
+
+// Directories
+const t_glob_listing *glob_list(t_glob_cache *cache, const char *path);
+bool glob_is_directory(const char *path, const t_glob_dirent *entry);
+
+#endif
@@ -0,0 +1,183 @@
+#include <string.h>
+
+#include "glob_internal.h"
+
+/**
+ * @brief Builds the membership bitmap of the bracket expression `text`,
+ * brackets included.
+ *
+ * A leading `!` or `^` negates it, `a-z` is a range of byte values, and a
+ * `-` first or last stands for itself.
+ */
+static const unsigned char *glob_compile_set(t_arena *arena, const char *text,
+                                             size_t length) {
+  unsigned char *set = arena_calloc(arena, GLOB_SET_SIZE);
+  size_t end = length - 1;
+  size_t i = 1;
+  bool negated = text[i] == '!' || text[i] == '^';
+
+  for (i += negated; i < end; ++i) {
+    unsigned low = (unsigned char)text[i];
+    unsigned high = low;
+    if (i + 2 < end && text[i + 1] == '-') {
+      high = (unsigned char)text[i + 2];
+      i += 2;
+    }
+    for (unsigned c = low; c <= high; ++c) set[c / 8] |= 1 << (c % 8);
+  }
+
+  if (negated) {
+    for (size_t k = 0; k < GLOB_SET_SIZE; ++k) set[k] = ~set[k];
+  }
+  return set;
+}
+
+/**
+ * @brief Picks the cheapest strategy that matches like the atoms would.
+ */
+static void glob_compile_matcher(t_glob *glob, t_glob_matcher *matcher) {
+  const t_glob_atom *atoms = matcher->atoms;
+  size_t stars = 0;
+  size_t star = 0;
+  bool plain = true;
+
+  for (size_t i = 0; i < matcher->count; ++i) {
+    if (atoms[i].type == GLOB_ATOM_STAR) {
+      ++stars;
+      star = i;
+    } else if (atoms[i].type != GLOB_ATOM_CHAR) {
+      plain = false;
+    }
+  }
+
+  matcher->strategy = GLOB_GENERAL;
+  if (plain && stars == 0) {
+    matcher->strategy = GLOB_LITERAL;
+  } else if (plain && stars == 1 && star == 0) {
+    matcher->strategy = GLOB_SUFFIX;
+  } else if (plain && stars == 1 && star + 1 == matcher->count) {
+    matcher->strategy = GLOB_PREFIX;
+  }
+  matcher->matches_dot = matcher->count > 0 &&
+                         atoms[0].type == GLOB_ATOM_CHAR && atoms[0].c == '.';
+
+  // The fixed bytes, for the strategies that compare them at once
+  matcher->text = arena_alloc(glob->cache->arena, matcher->count + 1);
+  matcher->length = 0;
+  for (size_t i = 0; i < matcher->count; ++i) {
+    if (atoms[i].type == GLOB_ATOM_CHAR) {
+      matcher->text[matcher->length++] = atoms[i].c;
+    }
+  }
+  matcher->text[matcher->length] = '\0';
+}
+
+size_t glob_compile(t_glob *glob, const t_word_segment *segments,
+                    size_t segment_count) {
+  t_arena *arena = glob->cache->arena;
+  size_t atom_count = 0;
+  size_t component_count = 1;
+
+  for (size_t i = 0; i < segment_count; ++i) {
+    if (segments[i].type != WORD_SEGMENT_LITERAL) {
+      ++atom_count;
+      continue;
+    }
+    atom_count += segments[i].length;
+    for (size_t k = 0; k < segments[i].length; ++k) {
+      component_count += segments[i].text[k] == '/';
+    }
+  }
+
+  t_glob_atom *atoms = arena_alloc(arena, atom_count * sizeof(t_glob_atom));
+  glob->components =
+      arena_alloc(arena, component_count * sizeof(t_glob_matcher));
+
+  // Slashes only ever come from literal text and split the components
+  t_glob_matcher *matcher = glob->components;
+  *matcher = (t_glob_matcher){.atoms = atoms, .count = 0};
+  for (size_t i = 0; i < segment_count; ++i) {
+    const t_word_segment *segment = &segments[i];
+    t_glob_atom *atom = &atoms[matcher->atoms - atoms + matcher->count];
+
+    if (segment->type == WORD_SEGMENT_ANY_STRING) {
+      *atom = (t_glob_atom){.type = GLOB_ATOM_STAR};
+    } else if (segment->type == WORD_SEGMENT_ANY_CHAR) {
+      *atom = (t_glob_atom){.type = GLOB_ATOM_ANY};
+    } else if (segment->type == WORD_SEGMENT_BRACKET) {
+      *atom = (t_glob_atom){
+          .type = GLOB_ATOM_SET,
+          .set = glob_compile_set(arena, segment->text, segment->length),
+      };
+    } else {
+      for (size_t k = 0; k < segment->length; ++k) {
+        if (segment->text[k] == '/') {
+          glob_compile_matcher(glob, matcher);
+          t_glob_atom *next = atom;
+          *++matcher = (t_glob_matcher){.atoms = next, .count = 0};
+          continue;
+        }
+        *atom++ = (t_glob_atom){.type = GLOB_ATOM_CHAR,
+                                .c = (unsigned char)segment->text[k]};
+        ++matcher->count;
+      }
+      continue;
+    }
+    ++matcher->count;
+  }
+  glob_compile_matcher(glob, matcher);
+  return component_count;
+}
+
+bool glob_match(const t_glob_matcher *matcher, const char *name) {
+  size_t length;
+
+  switch (matcher->strategy) {
+    case GLOB_LITERAL:
+      return strcmp(name, matcher->text) == 0;
+    case GLOB_PREFIX:
+      return strncmp(name, matcher->text, matcher->length) == 0;
+    case GLOB_SUFFIX:
+      length = strlen(name);
+      return length >= matcher->length &&
+             memcmp(name + length - matcher->length, matcher->text,
+                    matcher->length) == 0;
+    default:
+      return glob_match_atoms(matcher->atoms, matcher->count, name);
+  }
+}
+
+/**
+ * @brief Matches `name` against the atoms, backtracking to the last `*`
+ * only: every earlier `*` can already absorb whatever it needs to, so the
+ * loop stays linear on common patterns.
+ */
+bool glob_match_atoms(const t_glob_atom *atoms, size_t count,
+                      const char *name) {
+  size_t atom = 0;
+  size_t star = count;
+  const char *resume = NULL;
+
+  while (*name) {
+    unsigned char c = *name;
+    if (atom < count && atoms[atom].type == GLOB_ATOM_STAR) {
+      star = ++atom;
+      resume = name;
+    } else if (atom < count &&
+               (atoms[atom].type == GLOB_ATOM_ANY ||
+                (atoms[atom].type == GLOB_ATOM_CHAR && atoms[atom].c == c) ||
+                (atoms[atom].type == GLOB_ATOM_SET &&
+                 atoms[atom].set[c / 8] & (1 << (c % 8))))) {
+      ++atom;
+      ++name;
+    } else if (resume) {
+      atom = star;
+      name = ++resume;
+    } else {
+      return false;
+    }
+  }
+
+  while (atom < count && atoms[atom].type == GLOB_ATOM_STAR) ++atom;
+  return atom == count;
+}
@@ -0,0 +1,205 @@
+#define _GNU_SOURCE
+
+#include "heredoc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "arena/arena.h"
+#include "expander/expander.h"
+#include "heredoc_internal.h"
+#include "minishell.h"
+
+bool heredoc_collect(t_ast *ast, t_heredoc_reader read_line, void *context,
+                     const t_environment *environment) {
+  t_heredoc_source source = {
+      .read_line = read_line,
+      .context = context,
+      .environment = environment,
+  };
+
+  bool collected = heredoc_walk(ast, heredoc_read_body, &source);
+  if (source.arena) arena_free(source.arena);
+  return collected;
+}
+
+/**
+ * @brief Closes the body of one here-document.
+ */
+static bool heredoc_close_body(t_io_file *io_file, void *context) {
+  (void)context;
+
+  if (io_file->fd != -1) {
+    close(io_file->fd);
+    io_file->fd = -1;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads past the body of one here-document.
+ */
+static bool heredoc_skip_body(t_io_file *io_file, void *context) {
+  const t_heredoc_source *source = context;
+  size_t delimiter = strlen(io_file->filename);
+  const char *line;
+  size_t length;
+
+  while ((line = source->read_line(source->context, &length))) {
+    if (heredoc_is_delimiter(line, length, io_file->filename, delimiter)) {
+      break;
+    }
+  }
+  return true;
+}
+
+void heredoc_skip(t_ast *ast, t_heredoc_reader read_line, void *context) {
+  t_heredoc_source source = {.read_line = read_line, .context = context};
+
+  heredoc_walk(ast, heredoc_skip_body, &source);
+}
+
+void heredoc_close(t_ast *ast) { heredoc_walk(ast, heredoc_close_body, NULL); }
+
+bool heredoc_walk(t_ast *ast, t_heredoc_visitor visit, void *context) {
+  t_ast **children = NULL;
+  size_t count = 0;
+
+  switch (ast->type) {
+    case AST_LIST:
+      children = ast->list.children;
+      count = ast->list.count;
+      break;
+    case AST_AND_OR:
+      children = ast->and_or.children;
+      count = ast->and_or.count;
+      break;
+    case AST_PIPE_SEQUENCE:
+      children = ast->pipe_sequence.children;
+      count = ast->pipe_sequence.count;
+      break;
+    case AST_SUBSHELL:
+      return heredoc_walk(ast->subshell.list, visit, context);
+    case AST_BACKGROUND:
+      return heredoc_walk(ast->background.command, visit, context);
+    case AST_SIMPLE_COMMAND:
+      for (size_t i = 0; i < ast->simple_command.io_file_count; ++i) {
+        t_io_file *io_file = &ast->simple_command.io_files[i];
+        if (io_file->op->type == TOKEN_DLESS && !visit(io_file, context)) {
+          return false;
+        }
+      }
+      return true;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (!heredoc_walk(children[i], visit, context)) return false;
+  }
+  return true;
+}
+
+bool heredoc_is_delimiter(const char *line, size_t length,
+                          const char *delimiter, size_t delimiter_length) {
+  return length == delimiter_length && memcmp(line, delimiter, length) == 0;
+}
+
+bool heredoc_read_body(t_io_file *io_file, void *context) {
+  t_heredoc_source *source = context;
+  size_t delimiter = strlen(io_file->filename);
+  t_writer body;
+  const char *line;
+  size_t length;
+
+  // The body starts in the writer's buffer and only moves to a memory file
+  // once it outgrows it; lines are written from where the reader holds them
+  writer_init(&body, -1);
+  while ((line = source->read_line(source->context, &length))) {
+    // The lexer already removed the quotes the delimiter was written with
+    if (heredoc_is_delimiter(line, length, io_file->filename, delimiter)) {
+      break;
+    }
+
+    // Each line is expanded into the arena, which only has to hold one
+    if (!io_file->quoted) {
+      if (!source->arena) source->arena = arena_new(HEREDOC_ARENA_CHUNK_SIZE);
+      arena_reset(source->arena);
+      line = expander_heredoc_line(line, &length, source->environment,
+                                   source->arena);
+    }
+
+    if (!heredoc_append(&body, line, length)) {
+      if (body.fd != -1) close(body.fd);
+      return false;
+    }
+  }
+
+  if (!line) {
+    fprintf(stderr,
+            "%s: warning: here-document delimited by end-of-file (wanted "
+            "`%s')\n",
+            MINISHELL_NAME, io_file->filename);
+  }
+
+  io_file->fd = heredoc_finish(&body);
+  return io_file->fd != -1;
+}
+
+bool heredoc_append(t_writer *body, const char *line, size_t length) {
+  if (body->fd == -1 &&
+      body->length + length + 1 > sizeof(body->buffer)) {
+    body->fd = memfd_create(HEREDOC_MEMFD_NAME, MFD_CLOEXEC);
+    if (body->fd == -1) {
+      perror(MINISHELL_NAME);
+      return false;
+    }
+  }
+
+  writer_write(body, line, length);
+  writer_putc(body, '\n');
+  if (body->error) {
+    errno = body->error;
+    perror(MINISHELL_NAME);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the read end of the collected body.
+ *
+ * A body still in the writer's buffer fits in an empty pipe, so the shell
+ * writes it at once without waiting for a reader.
+ *
+ * @return The descriptor, or -1 on failure.
+ */
+int heredoc_finish(t_writer *body) {
+  if (body->fd != -1) {
+    if (writer_flush(body) == -1 || lseek(body->fd, 0, SEEK_SET) == -1) {
+      perror(MINISHELL_NAME);
+      close(body->fd);
+      return -1;
+    }
+    return body->fd;
+  }
+
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC) == -1) {
+    perror(MINISHELL_NAME);
+    return -1;
+  }
+
+  body->fd = pipe_fds[1];
+  int error = writer_flush(body);
+  close(pipe_fds[1]);
+  if (error == -1) {
+    perror(MINISHELL_NAME);
+    close(pipe_fds[0]);
+    return -1;
+  }
+  return pipe_fds[0];
+}
@@ -0,0 +1,45 @@
+#ifndef HEREDOC_H
+#define HEREDOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ast/ast.h"
+#include "environment/environment.h"
+
+/**
+ * @brief Reads the next line of a here-document body, and stores its length
+ * in `*length`.
+ *
+ * @return The line without its newline, or NULL at the end of the input. It
+ * is borrowed from the reader's own buffer, such as the mapped script, and
+ * stays valid only until the next call.
+ */
+typedef const char *(*t_heredoc_reader)(void *context, size_t *length);
+
+/**
+ * @brief Reads the body of every here-document in `ast`, in the order they
+ * appear, and stores its read end in the redirection.
+ *
+ * Bodies are streamed to a memory file as they are read, so a large one is
+ * never held in memory; a body small enough for a pipe is handed over in one.
+ * Unless its delimiter was quoted, the parameters of each line are expanded
+ * with `environment`.
+ *
+ * @return false if a body could not be stored.
+ */
+bool heredoc_collect(t_ast *ast, t_heredoc_reader read_line, void *context,
+                     const t_environment *environment);
+
+/**
+ * @brief Reads past the body of every here-document in `ast` without
+ * storing them, to find where the input that follows them starts.
+ */
+void heredoc_skip(t_ast *ast, t_heredoc_reader read_line, void *context);
+
+/**
+ * @brief Closes the bodies collected for `ast`.
+ */
+void heredoc_close(t_ast *ast);
+
+#endif
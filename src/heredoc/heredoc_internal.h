@@ -0,0 +1,43 @@
+#ifndef HEREDOC_INTERNAL_H
+#define HEREDOC_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "heredoc.h"
+#include "writer/writer.h"
+
+/**
+ * @brief Name of the memory files holding large bodies, as seen in
+ * `/proc/<pid>/fd`.
+ */
+#define HEREDOC_MEMFD_NAME "minishell-heredoc"
+
+/**
+ * @brief Size of the chunks of the arena body lines are expanded into; it
+ * is reset after every line.
+ */
+#define HEREDOC_ARENA_CHUNK_SIZE 4096
+
+typedef bool (*t_heredoc_visitor)(t_io_file *io_file, void *context);
+
+/**
+ * @brief Where bodies are read from.
+ *
+ * `arena` is only created once a body needs expanding.
+ */
+typedef struct s_heredoc_source {
+  t_heredoc_reader read_line;
+  void *context;
+  const t_environment *environment;
+  t_arena *arena;
+} t_heredoc_source;
+
+bool heredoc_walk(t_ast *ast, t_heredoc_visitor visit, void *context);
+bool heredoc_is_delimiter(const char *line, size_t length,
+                          const char *delimiter, size_t delimiter_length);
+bool heredoc_read_body(t_io_file *io_file, void *context);
+bool heredoc_append(t_writer *body, const char *line, size_t length);
+int heredoc_finish(t_writer *body);
+
+#endif
@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "job.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "evaluator/evaluator.h"
+#include "job_internal.h"
+#include "reaper/reaper.h"
+
+t_job_table *job_table(void) {
+  static t_job_table table = {.last_pid = 0};
+
+  // A forked child cannot wait for its parent's jobs
+  if (table.owner != getpid()) {
+    for (size_t i = 0; i < JOB_TABLE_SIZE && table.owner != 0; ++i) {
+      table.jobs[i].inherited = table.jobs[i].state != JOB_FREE;
+    }
+    table.owner = getpid();
+  }
+  return &table;
+}
+
+int job_add(pid_t pid, const t_ast *command) {
+  t_job_table *table = job_table();
+  t_job *job = NULL;
+
+  // The table is bounded: a new job waits for a slot to be given back
+  while (true) {
+    for (size_t i = 0; i < JOB_TABLE_SIZE && !job; ++i) {
+      if (table->jobs[i].state == JOB_FREE) job = &table->jobs[i];
+    }
+    if (job) break;
+    job_notify(STDERR_FILENO);
+    for (size_t i = 0; i < JOB_TABLE_SIZE && !job; ++i) {
+      if (table->jobs[i].state == JOB_FREE) job = &table->jobs[i];
+    }
+    if (job) break;
+    job_wait_next();
+  }
+
+  reaper_watch(pid);
+  *job = (t_job){.state = JOB_RUNNING, .pid = pid, .status = 0};
+  t_job_text text = {.buffer = job->command, .size = JOB_COMMAND_SIZE};
+  job_describe(&text, command);
+  table->last_pid = pid;
+  return job_number(job);
+}
+
+t_job *job_get(int number) {
+  if (number < 1 || number > JOB_TABLE_SIZE) return NULL;
+
+  t_job *job = &job_table()->jobs[number - 1];
+  return job->state == JOB_FREE ? NULL : job;
+}
+
+t_job *job_find(pid_t pid) {
+  t_job_table *table = job_table();
+
+  for (size_t i = 0; i < JOB_TABLE_SIZE; ++i) {
+    if (table->jobs[i].state != JOB_FREE && table->jobs[i].pid == pid) {
+      return &table->jobs[i];
+    }
+  }
+  return NULL;
+}
+
+int job_number(const t_job *job) {
+  return (int)(job - job_table()->jobs) + 1;
+}
+
+int job_wait(t_job *job) {
+  if (job->inherited) return EVALUATOR_STATUS_NOT_FOUND;
+  if (job->state == JOB_RUNNING) {
+    int wait_status = reaper_wait(job->pid, NULL);
+    if (!job_finish(job, wait_status)) return EVALUATOR_STATUS_NOT_FOUND;
+  }
+
+  int status = job->status;
+  job_remove(job);
+  return status;
+}
+
+int job_wait_next(void) {
+  t_job_table *table = job_table();
+  pid_t pids[JOB_TABLE_SIZE];
+  size_t count = 0;
+  int wait_status;
+
+  // A job that already finished is the next one
+  for (size_t i = 0; i < JOB_TABLE_SIZE; ++i) {
+    if (table->jobs[i].inherited) continue;
+    if (table->jobs[i].state == JOB_DONE) return job_wait(&table->jobs[i]);
+    if (table->jobs[i].state == JOB_RUNNING) pids[count++] = table->jobs[i].pid;
+  }
+
+  pid_t pid = reaper_wait_any(pids, count, &wait_status);
+  if (pid == -1) return -1;
+
+  t_job *job = job_find(pid);
+  if (!job_finish(job, wait_status)) return EVALUATOR_STATUS_NOT_FOUND;
+  return job_wait(job);
+}
+
+void job_reap(void) {
+  t_job_table *table = job_table();
+  int wait_status;
+
+  for (size_t i = 0; i < JOB_TABLE_SIZE; ++i) {
+    t_job *job = &table->jobs[i];
+    if (job->state == JOB_RUNNING && !job->inherited &&
+        reaper_try(job->pid, &wait_status)) {
+      job_finish(job, wait_status);
+    }
+  }
+}
+
+void job_notify(int fd) {
+  t_job_table *table = job_table();
+  t_writer writer;
+
+  job_reap();
+  writer_init(&writer, fd);
+  for (size_t i = 0; i < JOB_TABLE_SIZE; ++i) {
+    if (table->jobs[i].state == JOB_DONE && !table->jobs[i].inherited) {
+      job_print_one(&writer, &table->jobs[i], false);
+      job_remove(&table->jobs[i]);
+    }
+  }
+  writer_flush(&writer);
+}
+
+int job_print(int fd, bool with_pids) {
+  t_job_table *table = job_table();
+  t_writer writer;
+
+  job_reap();
+  writer_init(&writer, fd);
+  for (size_t i = 0; i < JOB_TABLE_SIZE; ++i) {
+    if (table->jobs[i].state == JOB_FREE) continue;
+    job_print_one(&writer, &table->jobs[i], with_pids);
+    if (table->jobs[i].state == JOB_DONE) job_remove(&table->jobs[i]);
+  }
+  return writer_flush(&writer);
+}
+
+pid_t job_last_pid(void) { return job_table()->last_pid; }
+
+bool job_finish(t_job *job, int wait_status) {
+  // A status that could not be collected is not the job's to report
+  if (wait_status == -1) {
+    job_remove(job);
+    return false;
+  }
+  job->state = JOB_DONE;
+  job->status = evaluator_status(wait_status);
+  return true;
+}
+
+void job_remove(t_job *job) { job->state = JOB_FREE; }
+
+void job_print_one(t_writer *writer, const t_job *job, bool with_pids) {
+  char line[64];
+
+  if (with_pids) {
+    snprintf(line, sizeof(line), "[%d] %ld ", job_number(job),
+             (long)job->pid);
+  } else {
+    snprintf(line, sizeof(line), "[%d]  ", job_number(job));
+  }
+  writer_puts(writer, line);
+
+  if (job->state == JOB_RUNNING) {
+    snprintf(line, sizeof(line), "%-12s", "Running");
+  } else if (job->status == 0) {
+    snprintf(line, sizeof(line), "%-12s", "Done");
+  } else {
+    snprintf(line, sizeof(line), "Exit %-7d", job->status);
+  }
+  writer_puts(writer, line);
+  writer_puts(writer, job->command);
+  writer_puts(writer, " &\n");
+}
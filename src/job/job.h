@@ -0,0 +1,110 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "ast/ast.h"
+
+/**
+ * @brief Size of the job table; starting a job while it is full first waits
+ * for one to finish.
+ */
+#define JOB_TABLE_SIZE 64
+
+/**
+ * @brief Room for the text a job is listed with; longer commands are cut.
+ */
+#define JOB_COMMAND_SIZE 128
+
+typedef enum e_job_state {
+  JOB_FREE,
+  JOB_RUNNING,
+  JOB_DONE,
+} t_job_state;
+
+/**
+ * @brief An asynchronous command.
+ *
+ * `pid` is the shell process running the command, which also leads the
+ * job's process group; every process of a background pipeline belongs to
+ * it. `status` is the exit status once the job is done. An `inherited` job
+ * was started by the parent of a forked shell, such as a subshell: it is
+ * listed as it was at the fork, but never waited for.
+ */
+typedef struct s_job {
+  t_job_state state;
+  pid_t pid;
+  int status;
+  bool inherited;
+  char command[JOB_COMMAND_SIZE];
+} t_job;
+
+/**
+ * @brief Records a job started for `command`.
+ *
+ * @return The job number, counted from 1.
+ */
+int job_add(pid_t pid, const t_ast *command);
+
+/**
+ * @brief Looks a job up by its number.
+ *
+ * @return The job, or NULL if no job has that number.
+ */
+t_job *job_get(int number);
+
+/**
+ * @brief Looks a job up by the pid of its leader.
+ */
+t_job *job_find(pid_t pid);
+
+/**
+ * @brief The job number of `job`.
+ */
+int job_number(const t_job *job);
+
+/**
+ * @brief Waits for `job` to finish and removes it from the table.
+ *
+ * @return Its exit status, or `EVALUATOR_STATUS_NOT_FOUND` if it is not a
+ * child of this process.
+ */
+int job_wait(t_job *job);
+
+/**
+ * @brief Waits for the next running job of this process to finish and
+ * removes it.
+ *
+ * @return Its exit status, or -1 if no job is running.
+ */
+int job_wait_next(void);
+
+/**
+ * @brief Collects every job of this process that finished, without
+ * blocking.
+ */
+void job_reap(void);
+
+/**
+ * @brief Reports the jobs that finished since the last call on `fd` and
+ * removes them.
+ */
+void job_notify(int fd);
+
+/**
+ * @brief Lists every job on `fd`, removing the finished ones.
+ *
+ * @param with_pids Whether each line shows the pid of the job.
+ * @return 0 on success, or -1 with `errno` set if the list could not be
+ * written.
+ */
+int job_print(int fd, bool with_pids);
+
+/**
+ * @brief The pid of the most recent background command, or 0 if none was
+ * started yet.
+ */
+pid_t job_last_pid(void);
+
+#endif
@@ -0,0 +1,70 @@
+#include <string.h>
+
+#include "job_internal.h"
+#include "token/token.h"
+
+void job_describe(t_job_text *text, const t_ast *ast) {
+  switch (ast->type) {
+    case AST_LIST:
+      for (size_t i = 0; i < ast->list.count; ++i) {
+        if (i > 0) job_describe_append(text, "; ");
+        job_describe(text, ast->list.children[i]);
+      }
+      break;
+    case AST_AND_OR:
+      for (size_t i = 0; i < ast->and_or.count; ++i) {
+        if (i > 0) {
+          job_describe_append(text, " ");
+          job_describe_append(text, ast->and_or.ops[i]->literal);
+          job_describe_append(text, " ");
+        }
+        job_describe(text, ast->and_or.children[i]);
+      }
+      break;
+    case AST_PIPE_SEQUENCE:
+      if (ast->pipe_sequence.timing == AST_TIMING_TEXT) {
+        job_describe_append(text, "time ");
+      } else if (ast->pipe_sequence.timing == AST_TIMING_JSON) {
+        job_describe_append(text, "time -j ");
+      }
+      for (size_t i = 0; i < ast->pipe_sequence.count; ++i) {
+        if (i > 0) job_describe_append(text, " | ");
+        job_describe(text, ast->pipe_sequence.children[i]);
+      }
+      break;
+    case AST_SUBSHELL:
+      job_describe_append(text, "(");
+      job_describe(text, ast->subshell.list);
+      job_describe_append(text, ")");
+      break;
+    case AST_BACKGROUND:
+      job_describe(text, ast->background.command);
+      job_describe_append(text, " &");
+      break;
+    case AST_SIMPLE_COMMAND:
+      for (size_t i = 0; i < ast->simple_command.argc; ++i) {
+        if (i > 0) job_describe_append(text, " ");
+        job_describe_append(text, ast->simple_command.argv[i]);
+      }
+      for (size_t i = 0; i < ast->simple_command.io_file_count; ++i) {
+        const t_io_file *io_file = &ast->simple_command.io_files[i];
+        if (i > 0 || ast->simple_command.argc > 0) {
+          job_describe_append(text, " ");
+        }
+        job_describe_append(text, io_file->op->literal);
+        job_describe_append(text, " ");
+        job_describe_append(text, io_file->filename);
+      }
+      break;
+  }
+}
+
+void job_describe_append(t_job_text *text, const char *str) {
+  size_t length = strlen(str);
+  size_t room = text->size - 1 - text->length;
+
+  if (length > room) length = room;
+  memcpy(text->buffer + text->length, str, length);
+  text->length += length;
+  text->buffer[text->length] = '\0';
+}
@@ -0,0 +1,40 @@
+#ifndef JOB_INTERNAL_H
+#define JOB_INTERNAL_H
+
+#include <stddef.h>
+
+#include "job.h"
+#include "writer/writer.h"
+
+/**
+ * @brief The jobs of the shell process `owner`.
+ */
+typedef struct s_job_table {
+  t_job jobs[JOB_TABLE_SIZE];
+  pid_t last_pid;
+  pid_t owner;
+} t_job_table;
+
+/**
+ * @brief Accumulates a job's command text, dropping whatever does not fit.
+ */
+typedef struct s_job_text {
+  char *buffer;
+  size_t size;
+  size_t length;
+} t_job_text;
+
+t_job_table *job_table(void);
+/**
+ * @brief Records that `job` exited with `wait_status`.
+ *
+ * @return false if its status could not be collected; the job is then
+ * removed.
+ */
+bool job_finish(t_job *job, int wait_status);
+void job_remove(t_job *job);
+void job_print_one(t_writer *writer, const t_job *job, bool with_pids);
+void job_describe(t_job_text *text, const t_ast *ast);
+void job_describe_append(t_job_text *text, const char *str);
+
+#endif
@@ -1,148 +1,204 @@
 #include "lexer.h"
 
 #include <stdbool.h>
-#include <stdlib.h>
+#include <string.h>
 
-#include "ft_arraylist.h"
-#include "ft_ctype.h"
-#include "ft_stdlib.h"
+#include "arena/arena.h"
 #include "ft_string.h"
 #include "lexer_internal.h"
 #include "token/token.h"
 
-t_lexer *lexer_new(const char *input) {
-  t_lexer *lexer = ft_expect(malloc(sizeof(t_lexer)), __func__);
+t_lexer *lexer_new(t_arena *arena, const char *input) {
+  return lexer_new_range(arena, input, ft_strlen(input));
+}
+
+t_lexer *lexer_new_range(t_arena *arena, const char *input, size_t length) {
+  t_lexer *lexer = arena_alloc(arena, sizeof(t_lexer));
   *lexer = (t_lexer){
+      .arena = arena,
       .input = input,
-      .input_length = ft_strlen(input),
+      .input_length = length,
       .position = 0,
       .read_position = 0,
       .c = '\0',
-      .tokens = ft_expect(ft_arrnew(sizeof(t_token **)), __func__),
+      .word_index = 0,
+      .skip_plain = lexer_scanner(),
   };
   lexer_advance(lexer);
   return lexer;
 }
 
-void lexer_free(t_lexer *lexer) {
-  for (size_t i = 0; i < ft_arrsize(lexer->tokens); ++i) {
-    t_token **token = ft_arrat(lexer->tokens, i);
-    ft_stnfree((t_string)(*token)->literal);
-    token_free(*token);
-  }
-  ft_arrfree(lexer->tokens);
-  free(lexer);
+size_t lexer_offset(const t_lexer *lexer) {
+  return lexer->position < lexer->input_length ? lexer->position
+                                               : lexer->input_length;
 }
 
-#include <stdio.h>
-
-t_token *lexer_next_token(t_lexer *lexer) {
-  t_token token;
+const t_token *lexer_next_token(t_lexer *lexer) {
+  t_token_type type;
 
   lexer_skip_whitespace(lexer);
 
+  // A comment runs up to, but not including, the end of its line
+  if (lexer->c == '#') {
+    const char *newline = memchr(lexer->input + lexer->position, '\n',
+                                 lexer->input_length - lexer->position);
+    lexer_seek(lexer, newline ? (size_t)(newline - lexer->input)
+                              : lexer->input_length);
+  }
+
   switch (lexer->c) {
     case ';':
-      token = (t_token){.type = TOKEN_SEMI, .literal = ";"};
+      type = TOKEN_SEMI;
       break;
     case '&':
       if (lexer_peek(lexer) == '&') {
         lexer_advance(lexer);
-        token = (t_token){.type = TOKEN_AND_IF, .literal = "&&"};
+        type = TOKEN_AND_IF;
       } else {
-        token = (t_token){.type = TOKEN_ILLEGAL, .literal = "&"};
+        type = TOKEN_AMP;
       }
       break;
     case '|':
       if (lexer_peek(lexer) == '|') {
         lexer_advance(lexer);
-        token = (t_token){.type = TOKEN_OR_IF, .literal = "||"};
+        type = TOKEN_OR_IF;
       } else {
-        token = (t_token){.type = TOKEN_PIPE, .literal = "|"};
+        type = TOKEN_PIPE;
       }
       break;
     case '(':
-      token = (t_token){.type = TOKEN_LPAREN, .literal = "("};
+      type = TOKEN_LPAREN;
       break;
     case ')':
-      token = (t_token){.type = TOKEN_RPAREN, .literal = ")"};
+      type = TOKEN_RPAREN;
       break;
     case '<':
       if (lexer_peek(lexer) == '<') {
         lexer_advance(lexer);
-        token = (t_token){.type = TOKEN_DLESS, .literal = "<<"};
+        type = TOKEN_DLESS;
       } else {
-        token = (t_token){.type = TOKEN_LESS, .literal = "<"};
+        type = TOKEN_LESS;
       }
       break;
     case '>':
       if (lexer_peek(lexer) == '>') {
         lexer_advance(lexer);
-        token = (t_token){.type = TOKEN_DGREAT, .literal = ">>"};
+        type = TOKEN_DGREAT;
       } else {
-        token = (t_token){.type = TOKEN_GREAT, .literal = ">"};
+        type = TOKEN_GREAT;
       }
       break;
+    case '\n':
+      type = TOKEN_NEWLINE;
+      break;
     case '\0':
-      token = (t_token){.type = TOKEN_NEWLINE, .literal = "<newline>"};
+      if (lexer->position < lexer->input_length) return lexer_read_word(lexer);
+      type = TOKEN_EOF;
       break;
-    default: {
-      t_token *new_token = lexer_read_word(lexer);
-
-      if (!ft_arrappend(lexer->tokens, &new_token)) {
-        ft_panic(__func__);
-      }
-
-      return new_token;
-    }
+    default:
+      return lexer_read_word(lexer);
   }
 
   lexer_advance(lexer);
 
-  t_token *new_token = token_new((t_token){
-      .type = token.type,
-      .literal = ft_expect(ft_stnnew(token.literal), __func__),
-  });
-
-  if (!ft_arrappend(lexer->tokens, &new_token)) {
-    ft_panic(__func__);
-  }
-
-  return new_token;
+  return token_operator(type);
 }
 
-t_token *lexer_read_word(t_lexer *lexer) {
+const t_token *lexer_read_word(t_lexer *lexer) {
   size_t start = lexer->position;
-  char quote = '\0';
-
-  while (!lexer_is_at_end(lexer) &&
-         (!lexer_is_metacharacter(lexer->c) || quote != '\0')) {
-    if (lexer->c == '\\') {
-      lexer_advance(lexer);
-      if (!lexer_is_at_end(lexer)) lexer_advance(lexer);
-      continue;
+  size_t end = start;
+  size_t expansions = 0;
+  bool plain = true;
+  bool quoted = false;
+
+  while (true) {
+    end = lexer->skip_plain(lexer->input, end, lexer->input_length);
+    if (end >= lexer->input_length) break;
+
+    unsigned char class =
+        g_lexer_char_classes[(unsigned char)lexer->input[end]];
+    if (class & LEXER_CHAR_META) break;
+    plain = false;
+    quoted |= (class & (LEXER_CHAR_QUOTE | LEXER_CHAR_ESCAPE)) != 0;
+    if (class & LEXER_CHAR_ESCAPE) {
+      end += end + 1 < lexer->input_length ? 2 : 1;
+    } else if (class & LEXER_CHAR_GLOB) {
+      // Only counted: whether `[` opens a bracket expression is settled
+      // while unquoting
+      ++expansions;
+      ++end;
+    } else if (class & LEXER_CHAR_DOLLAR) {
+      t_word_segment segment;
+      size_t length =
+          lexer_expansion(lexer->input, lexer->input_length, end, &segment);
+      expansions += length > 0;
+      end += length > 0 ? length : 1;
+    } else {
+      end = lexer_skip_quoted(lexer, end, &expansions);
     }
-    if (lexer_is_quoting(lexer->c)) {
-      if (quote == '\0') {
-        quote = lexer->c;
-        lexer_advance(lexer);
-        continue;
-      } else if (quote == lexer->c) {
-        quote = '\0';
-        lexer_advance(lexer);
-        continue;
-      }
-    }
-    lexer_advance(lexer);
   }
 
-  size_t end = lexer->position;
+  lexer_seek(lexer, end);
+
+  // Each word gets its own copy, so the input is never written to and a
+  // mapped file is never copied as a whole
+  char *text = arena_alloc(lexer->arena, end - start + 1);
+  const t_word_expansion *expansion = NULL;
+  if (plain) {
+    memcpy(text, lexer->input + start, end - start);
+    text[end - start] = '\0';
+  } else {
+    expansion = lexer_unquote(lexer, text, start, end, expansions);
+  }
 
-  return token_new((t_token){
+  t_token *token = &lexer->words[lexer->word_index++ % LEXER_WORD_SLOTS];
+  *token = (t_token){
       .type = TOKEN_WORD,
-      .literal = ft_expect(ft_stnnew_size(lexer->input + start, end - start),
-                           __func__),
-  });
+      .literal = text,
+      .offset = start,
+      .length = end - start,
+      .expansion = expansion,
+      .quoted = quoted,
+  };
+  return token;
+}
+
+/**
+ * @brief Skips the quoted section opening at `position`, counting the
+ * expansions of a double-quoted one into `expansions`.
+ *
+ * An unterminated quote extends to the end of the input.
+ *
+ * @return The position just past the closing quote.
+ */
+size_t lexer_skip_quoted(const t_lexer *lexer, size_t position,
+                         size_t *expansions) {
+  const char *input = lexer->input;
+  char quote = input[position++];
+
+  if (quote == '\'') {
+    const char *close =
+        memchr(input + position, quote, lexer->input_length - position);
+    return close ? (size_t)(close - input) + 1 : lexer->input_length;
+  }
+
+  while (position < lexer->input_length && input[position] != quote) {
+    t_word_segment segment;
+    size_t length = input[position] == '$'
+                        ? lexer_expansion(input, lexer->input_length,
+                                          position, &segment)
+                        : 0;
+    *expansions += length > 0;
+    if (length == 0) length = input[position] == '\\' ? 2 : 1;
+    position += length;
+  }
+  return position < lexer->input_length ? position + 1 : lexer->input_length;
+}
+
+void lexer_seek(t_lexer *lexer, size_t position) {
+  lexer->position = position;
+  lexer->read_position = position + 1;
+  lexer->c = position < lexer->input_length ? lexer->input[position] : '\0';
 }
 
 void lexer_advance(t_lexer *lexer) {
@@ -159,16 +215,21 @@ char lexer_peek(const t_lexer *lexer) {
 }
 
 void lexer_skip_whitespace(t_lexer *lexer) {
-  while (ft_isspace(lexer->c)) {
-    lexer_advance(lexer);
+  const char *input = lexer->input;
+  size_t position = lexer->position;
+
+  // A backslash-newline joins two lines, so it is skipped like a blank
+  while (position < lexer->input_length) {
+    if (g_lexer_char_classes[(unsigned char)input[position]] &
+        LEXER_CHAR_BLANK) {
+      ++position;
+    } else if (input[position] == '\\' &&
+               position + 1 < lexer->input_length &&
+               input[position + 1] == '\n') {
+      position += 2;
+    } else {
+      break;
+    }
   }
+  lexer_seek(lexer, position);
 }
-
-bool lexer_is_at_end(const t_lexer *lexer) { return lexer->c == '\0'; }
-
-bool lexer_is_metacharacter(char c) {
-  return c == ' ' || c == '\t' || c == '\n' || c == '|' || c == '&' ||
-         c == ';' || c == '(' || c == ')' || c == '<' || c == '>';
-}
-
-bool lexer_is_quoting(char c) { return c == '\'' || c == '"'; }
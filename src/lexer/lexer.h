@@ -1,12 +1,41 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stddef.h>
+
+#include "arena/arena.h"
 #include "token/token.h"
 
 typedef struct s_lexer t_lexer;
 
-t_lexer *lexer_new(const char *input);
-void lexer_free(t_lexer *lexer);
-t_token *lexer_next_token(t_lexer *lexer);
+t_lexer *lexer_new(t_arena *arena, const char *input);
+
+/**
+ * @brief Creates a lexer over the `length` bytes at `input`, which need not
+ * be NUL-terminated and are never written to.
+ *
+ * Newlines are tokens, so a multi-line script, or a mapped file, can be
+ * lexed in place one complete command at a time.
+ */
+t_lexer *lexer_new_range(t_arena *arena, const char *input, size_t length);
+
+const t_token *lexer_next_token(t_lexer *lexer);
+
+/**
+ * @brief Returns how many bytes of the input the tokens read so far span;
+ * after a newline token, the offset of the line that follows.
+ */
+size_t lexer_offset(const t_lexer *lexer);
+
+/**
+ * @brief Recognizes `$NAME`, `${NAME}`, `$?`, `$$` or `$!` at `position` of
+ * the `length` bytes at `input`.
+ *
+ * The segment's text, for a parameter, points into the input.
+ *
+ * @return The length of the expansion, or 0 if the `$` stands for itself.
+ */
+size_t lexer_expansion(const char *input, size_t length, size_t position,
+                       t_word_segment *segment);
 
 #endif
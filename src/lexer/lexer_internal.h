@@ -3,25 +3,85 @@
 
 #include <stddef.h>
 
-#include "ft_arraylist.h"
+#include "arena/arena.h"
 #include "lexer.h"
 #include "token/token.h"
 
+/**
+ * @brief Number of word tokens kept alive at once.
+ *
+ * The parser only ever holds the current token and the one before it, so
+ * word tokens are handed out from a small ring instead of being allocated one
+ * by one.
+ */
+#define LEXER_WORD_SLOTS 2
+
+/**
+ * @brief Bytes that end a run of plain word bytes, for the vector scanners.
+ *
+ * Must list exactly the bytes that have a `LEXER_CHAR_WORD_SPECIAL` class.
+ */
+#define LEXER_SPECIALS " \t\n|&;()<>'\"\\$*?["
+
+/**
+ * @brief Bytes checked one at a time before a vector scanner kicks in.
+ *
+ * One AVX2 vector: typical words are shorter and never reach the vector
+ * loop, where a single round costs more than scanning them byte by byte.
+ */
+#define LEXER_SCALAR_PROLOGUE 32
+
+typedef enum e_lexer_char_class {
+  LEXER_CHAR_META = 1 << 0,
+  LEXER_CHAR_BLANK = 1 << 1,
+  LEXER_CHAR_QUOTE = 1 << 2,
+  LEXER_CHAR_ESCAPE = 1 << 3,
+  LEXER_CHAR_DOLLAR = 1 << 4,
+  LEXER_CHAR_GLOB = 1 << 5,
+  LEXER_CHAR_WORD_SPECIAL = LEXER_CHAR_META | LEXER_CHAR_QUOTE |
+                            LEXER_CHAR_ESCAPE | LEXER_CHAR_DOLLAR |
+                            LEXER_CHAR_GLOB,
+} t_lexer_char_class;
+
+extern const unsigned char g_lexer_char_classes[256];
+
+/**
+ * @brief Returns the position of the first byte at or after `position` that
+ * is not a plain word byte, or `length` if there is none.
+ */
+typedef size_t (*t_lexer_scanner)(const char *input, size_t position,
+                                  size_t length);
+
 struct s_lexer {
+  t_arena *arena;
   const char *input;
   size_t input_length;
   size_t position;
   size_t read_position;
   char c;
-  t_array *tokens;
+  t_token words[LEXER_WORD_SLOTS];
+  size_t word_index;
+  t_lexer_scanner skip_plain;
 };
 
-t_token *lexer_read_word(t_lexer *lexer);
+const t_token *lexer_read_word(t_lexer *lexer);
+size_t lexer_skip_quoted(const t_lexer *lexer, size_t position,
+                         size_t *expansions);
+const t_word_expansion *lexer_unquote(t_lexer *lexer, char *text,
+                                      size_t start, size_t end,
+                                      size_t expansions);
+void lexer_seek(t_lexer *lexer, size_t position);
 void lexer_advance(t_lexer *lexer);
 char lexer_peek(const t_lexer *lexer);
 void lexer_skip_whitespace(t_lexer *lexer);
-bool lexer_is_at_end(const t_lexer *lexer);
-bool lexer_is_metacharacter(char c);
-bool lexer_is_quoting(char c);
+
+// Word scanners; `lexer_scanner` picks one for the running CPU
+t_lexer_scanner lexer_scanner(void);
+size_t lexer_skip_plain_scalar(const char *input, size_t position,
+                               size_t length);
+size_t lexer_skip_plain_sse2(const char *input, size_t position,
+                             size_t length);
+size_t lexer_skip_plain_avx2(const char *input, size_t position,
+                             size_t length);
 
 #endif
@@ -0,0 +1,167 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lexer_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEXER_HAS_X86 1
+#else
+#define LEXER_HAS_X86 0
+#endif
+
+const unsigned char g_lexer_char_classes[256] = {
+    [' '] = LEXER_CHAR_META | LEXER_CHAR_BLANK,
+    ['\t'] = LEXER_CHAR_META | LEXER_CHAR_BLANK,
+    ['\n'] = LEXER_CHAR_META,
+    ['\v'] = LEXER_CHAR_BLANK,
+    ['\f'] = LEXER_CHAR_BLANK,
+    ['\r'] = LEXER_CHAR_BLANK,
+    ['|'] = LEXER_CHAR_META,
+    ['&'] = LEXER_CHAR_META,
+    [';'] = LEXER_CHAR_META,
+    ['('] = LEXER_CHAR_META,
+    [')'] = LEXER_CHAR_META,
+    ['<'] = LEXER_CHAR_META,
+    ['>'] = LEXER_CHAR_META,
+    ['\''] = LEXER_CHAR_QUOTE,
+    ['"'] = LEXER_CHAR_QUOTE,
+    ['\\'] = LEXER_CHAR_ESCAPE,
+    ['$'] = LEXER_CHAR_DOLLAR,
+    ['*'] = LEXER_CHAR_GLOB,
+    ['?'] = LEXER_CHAR_GLOB,
+    ['['] = LEXER_CHAR_GLOB,
+};
+
+/**
+ * @brief Low-nibble half of the AVX2 classifier.
+ *
+ * Bit `h` of entry `l` is set when byte `0xhl` is special, so a byte is
+ * special exactly when its entry shares a bit with `1 << h`. Only ASCII bytes
+ * can be special.
+ */
+static unsigned char g_lexer_low_nibbles[16];
+
+size_t lexer_skip_plain_scalar(const char *input, size_t position,
+                               size_t length) {
+  while (position < length &&
+         !(g_lexer_char_classes[(unsigned char)input[position]] &
+           LEXER_CHAR_WORD_SPECIAL)) {
+    ++position;
+  }
+  return position;
+}
+
+/**
+ * @brief Scans at most `LEXER_SCALAR_PROLOGUE` bytes one at a time.
+ *
+ * Most words are short, and resolving them without touching vector registers
+ * is cheaper than a full vector round. Past the probe, the vector loop only
+ * runs while a whole vector remains; the tail is scanned one byte at a time.
+ *
+ * @return true if a special byte or the end was found.
+ */
+static inline bool lexer_skip_plain_prologue(const char *input,
+                                             size_t *position, size_t length) {
+  size_t limit = *position + LEXER_SCALAR_PROLOGUE;
+
+  if (limit > length) limit = length;
+  while (*position < limit) {
+    if (g_lexer_char_classes[(unsigned char)input[*position]] &
+        LEXER_CHAR_WORD_SPECIAL) {
+      return true;
+    }
+    ++*position;
+  }
+  return *position >= length;
+}
+
+#if LEXER_HAS_X86
+
+/**
+ * @brief Marks the bytes of `chunk` that end a run of plain word bytes.
+ *
+ * Every special byte costs one comparison; the list is a constant, so the
+ * loop is fully unrolled.
+ */
+static inline __m128i lexer_special_mask_sse2(__m128i chunk) {
+  __m128i mask = _mm_setzero_si128();
+  for (size_t k = 0; k < sizeof(LEXER_SPECIALS) - 1; ++k) {
+    mask = _mm_or_si128(
+        mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(LEXER_SPECIALS[k])));
+  }
+  return mask;
+}
+
+size_t lexer_skip_plain_sse2(const char *input, size_t position,
+                             size_t length) {
+  if (lexer_skip_plain_prologue(input, &position, length)) return position;
+  while (position + sizeof(__m128i) <= length) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(input + position));
+    unsigned bits = (unsigned)_mm_movemask_epi8(lexer_special_mask_sse2(chunk));
+    if (bits) return position + (size_t)__builtin_ctz(bits);
+    position += sizeof(__m128i);
+  }
+  return lexer_skip_plain_scalar(input, position, length);
+}
+
+/**
+ * @brief Classifies 32 bytes with two nibble lookups instead of one
+ * comparison per special byte.
+ */
+__attribute__((target("avx2"))) static inline unsigned lexer_special_bits_avx2(
+    __m256i chunk, __m256i low_table, __m256i high_table) {
+  __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  __m256i low =
+      _mm256_shuffle_epi8(low_table, _mm256_and_si256(chunk, nibble_mask));
+  __m256i high = _mm256_shuffle_epi8(
+      high_table, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble_mask));
+  __m256i plain =
+      _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+  return ~(unsigned)_mm256_movemask_epi8(plain);
+}
+
+__attribute__((target("avx2"))) size_t lexer_skip_plain_avx2(
+    const char *input, size_t position, size_t length) {
+  if (lexer_skip_plain_prologue(input, &position, length)) return position;
+
+  __m256i low_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)g_lexer_low_nibbles));
+  __m256i high_table = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,  //
+      1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  while (position + sizeof(__m256i) <= length) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *)(input + position));
+    unsigned bits = lexer_special_bits_avx2(chunk, low_table, high_table);
+    if (bits) return position + (size_t)__builtin_ctz(bits);
+    position += sizeof(__m256i);
+  }
+  return lexer_skip_plain_scalar(input, position, length);
+}
+
+#endif
+
+/**
+ * @brief Picks the widest scanner the running CPU supports.
+ */
+static t_lexer_scanner lexer_resolve_scanner(void) {
+  for (size_t k = 0; k < sizeof(LEXER_SPECIALS) - 1; ++k) {
+    unsigned char c = LEXER_SPECIALS[k];
+    g_lexer_low_nibbles[c & 0x0f] |= 1 << (c >> 4);
+  }
+
+#if LEXER_HAS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return lexer_skip_plain_avx2;
+  if (__builtin_cpu_supports("sse2")) return lexer_skip_plain_sse2;
+#endif
+  return lexer_skip_plain_scalar;
+}
+
+t_lexer_scanner lexer_scanner(void) {
+  static t_lexer_scanner scanner = NULL;
+
+  if (!scanner) scanner = lexer_resolve_scanner();
+  return scanner;
+}
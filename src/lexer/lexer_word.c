@@ -0,0 +1,226 @@
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "arena/arena.h"
+#include "lexer_internal.h"
+#include "token/token.h"
+
+/**
+ * @brief Bytes a backslash escapes between double quotes; before any other
+ * byte it stands for itself.
+ */
+#define LEXER_DQUOTE_ESCAPES "$`\"\\\n"
+
+/**
+ * @brief The word being unquoted into its copy, which never needs more room
+ * than its source: quotes and backslashes are only removed.
+ */
+typedef struct s_lexer_word {
+  char *text;
+  size_t length;
+  size_t literal_start;
+  t_word_expansion *expansion;
+  t_word_segment *segments;
+  bool expands;
+} t_lexer_word;
+
+size_t lexer_expansion(const char *input, size_t length, size_t position,
+                       t_word_segment *segment) {
+  size_t end = position + 1;
+  bool braced = end < length && input[end] == '{';
+
+  end += braced;
+  if (end >= length) return 0;
+  *segment = (t_word_segment){.text = NULL, .length = 0};
+  switch (input[end]) {
+    case '?':
+      segment->type = WORD_SEGMENT_STATUS;
+      break;
+    case '$':
+      segment->type = WORD_SEGMENT_SHELL_PID;
+      break;
+    case '!':
+      segment->type = WORD_SEGMENT_LAST_PID;
+      break;
+    default:
+      if (!isalpha((unsigned char)input[end]) && input[end] != '_') return 0;
+      segment->type = WORD_SEGMENT_PARAMETER;
+      segment->text = input + end;
+      while (end < length &&
+             (isalnum((unsigned char)input[end]) || input[end] == '_')) {
+        ++end;
+      }
+      segment->length = input + end - segment->text;
+      --end;
+  }
+  ++end;
+
+  // `${` must be closed right after the name
+  if (braced && (end >= length || input[end++] != '}')) {
+    return 0;
+  }
+  return end - position;
+}
+
+/**
+ * @brief Ends the literal segment written since the last expansion, if any.
+ */
+static void lexer_word_flush(t_lexer_word *word) {
+  if (!word->expansion || word->length == word->literal_start) return;
+  word->segments[word->expansion->count++] = (t_word_segment){
+      .type = WORD_SEGMENT_LITERAL,
+      .text = word->text + word->literal_start,
+      .length = word->length - word->literal_start,
+  };
+}
+
+/**
+ * @brief Records the expansion at `position` if there is one.
+ *
+ * Its source text stays in the word, so the literal still reads `$NAME`.
+ *
+ * @return The length of its source text, or 0 if `$` stands for itself.
+ */
+static size_t lexer_word_expansion(t_lexer *lexer, t_lexer_word *word,
+                                   size_t position) {
+  t_word_segment segment;
+  size_t length =
+      word->expansion ? lexer_expansion(lexer->input, lexer->input_length,
+                                        position, &segment)
+                      : 0;
+
+  if (length == 0) return 0;
+  lexer_word_flush(word);
+
+  // The name is read back from the copy kept in the word
+  char *source = word->text + word->length;
+  memcpy(source, lexer->input + position, length);
+  if (segment.text) {
+    segment.text = source + (segment.text - (lexer->input + position));
+  }
+  word->segments[word->expansion->count++] = segment;
+  word->length += length;
+  word->literal_start = word->length;
+  word->expands = true;
+  return length;
+}
+
+/**
+ * @brief Measures the bracket expression opening at `position`.
+ *
+ * A `]` right after the opening bracket, or after its negation, is a member.
+ * Quotes and backslashes are not supported inside.
+ *
+ * @return Its length, or 0 if the `[` stands for itself.
+ */
+static size_t lexer_bracket(const t_lexer *lexer, size_t position,
+                            size_t end) {
+  const char *input = lexer->input;
+  size_t i = position + 1;
+
+  if (i < end && (input[i] == '!' || input[i] == '^')) ++i;
+  if (i < end && input[i] == ']') ++i;
+  while (i < end && input[i] != ']') {
+    if (g_lexer_char_classes[(unsigned char)input[i]] &
+        (LEXER_CHAR_QUOTE | LEXER_CHAR_ESCAPE)) {
+      return 0;
+    }
+    ++i;
+  }
+  return i < end ? i + 1 - position : 0;
+}
+
+/**
+ * @brief Records the unquoted pattern character at `position`, keeping its
+ * source in the word.
+ *
+ * @return Its length, or 0 if it stands for itself.
+ */
+static size_t lexer_word_pattern(t_lexer *lexer, t_lexer_word *word,
+                                 size_t position, size_t end) {
+  t_word_segment segment = {.type = WORD_SEGMENT_BRACKET, .length = 1};
+
+  if (!word->expansion) return 0;
+  if (lexer->input[position] == '*') {
+    segment.type = WORD_SEGMENT_ANY_STRING;
+  } else if (lexer->input[position] == '?') {
+    segment.type = WORD_SEGMENT_ANY_CHAR;
+  } else if (!(segment.length = lexer_bracket(lexer, position, end))) {
+    return 0;
+  }
+
+  lexer_word_flush(word);
+  segment.text = word->text + word->length;
+  memcpy(word->text + word->length, lexer->input + position, segment.length);
+  word->segments[word->expansion->count++] = segment;
+  word->length += segment.length;
+  word->literal_start = word->length;
+  word->expansion->glob = true;
+  word->expands = true;
+  return segment.length;
+}
+
+const t_word_expansion *lexer_unquote(t_lexer *lexer, char *text,
+                                      size_t start, size_t end,
+                                      size_t expansions) {
+  const char *input = lexer->input;
+  t_lexer_word word = {.text = text};
+  char quote = '\0';
+  bool quoted = false;
+
+  // Only words that may expand anything get segments; at most one literal
+  // segment sits before and after each expansion.
+  if (expansions > 0) {
+    word.expansion = arena_alloc(lexer->arena, sizeof(t_word_expansion));
+    word.segments = arena_alloc(lexer->arena,
+                                (2 * expansions + 1) * sizeof(t_word_segment));
+    word.expansion->count = 0;
+    word.expansion->glob = false;
+  }
+
+  for (size_t i = start; i < end;) {
+    char c = input[i];
+    size_t length;
+
+    if (quote == '\'') {
+      if (c == '\'') {
+        quote = '\0';
+      } else {
+        word.text[word.length++] = c;
+      }
+      ++i;
+    } else if (c == quote) {
+      quote = '\0';
+      ++i;
+    } else if (!quote && (c == '\'' || c == '"')) {
+      quote = c;
+      quoted = true;
+      ++i;
+    } else if (c == '\\' && i + 1 < end && input[i + 1] == '\n') {
+      // A line continuation leaves nothing behind
+      i += 2;
+    } else if (c == '\\' && i + 1 < end &&
+               (!quote || strchr(LEXER_DQUOTE_ESCAPES, input[i + 1]))) {
+      word.text[word.length++] = input[i + 1];
+      i += 2;
+    } else if (c == '$' && (length = lexer_word_expansion(lexer, &word, i))) {
+      i += length;
+    } else if (!quote && (c == '*' || c == '?' || c == '[') &&
+               (length = lexer_word_pattern(lexer, &word, i, end))) {
+      i += length;
+    } else {
+      word.text[word.length++] = c;
+      ++i;
+    }
+  }
+
+  lexer_word_flush(&word);
+  word.text[word.length] = '\0';
+
+  // A lone `[` or `$` turned out to stand for itself
+  if (!word.expands) return NULL;
+  word.expansion->segments = word.segments;
+  word.expansion->quoted = quoted;
+  return word.expansion;
+}
@@ -1,14 +1,43 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "environment/environment.h"
+#include "minishell.h"
 #include "repl/repl.h"
+#include "script/script.h"
 
-int main(void) {
-  extern const char **environ;
+/**
+ * @brief Runs the mode selected by the arguments: the commands given to
+ * `-c`, a script file, the commands piped to the standard input, or the
+ * interactive REPL when the standard input is a terminal.
+ *
+ * @return The exit status of the shell.
+ */
+static int run(int argc, char **argv, t_environment *environment) {
+  if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+    if (argc < 3) {
+      fprintf(stderr, MINISHELL_NAME ": -c: option requires an argument\n");
+      return SCRIPT_STATUS_USAGE;
+    }
+    return script_run_string(argv[2], environment);
+  }
+  if (argc > 1) return script_run_file(argv[1], environment);
+  if (!isatty(STDIN_FILENO)) {
+    return script_run_fd(STDIN_FILENO, environment);
+  }
 
-  t_hashmap *environment = environment_new(environ);
   repl_start(environment);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  extern const char **environ;
+
+  t_environment *environment = environment_new(environ);
+  int status = run(argc, argv, environment);
   environment_free(environment);
 
-  return EXIT_SUCCESS;
+  return status;
 }
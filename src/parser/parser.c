@@ -2,115 +2,168 @@
 
 #include <stddef.h>
 #include <stdio.h>
-#include <stdlib.h>
+#include <string.h>
 
+#include "arena/arena.h"
 #include "ast/ast.h"
-#include "ft_stdlib.h"
-#include "ft_string.h"
 #include "minishell.h"
 #include "parser_internal.h"
 #include "token/token.h"
 
-t_parser *parser_new(t_lexer *lexer) {
-  t_parser *parser = ft_expect(malloc(sizeof(t_parser)), __func__);
+t_parser *parser_new(t_arena *arena, t_lexer *lexer) {
+  t_parser *parser = arena_alloc(arena, sizeof(t_parser));
   *parser = (t_parser){
+      .arena = arena,
       .lexer = lexer,
       .current_token = NULL,
-      .peek_token = NULL,
   };
   parser_advance(parser);
-  parser_advance(parser);
   return parser;
 }
 
-void parser_free(t_parser *parser) { free(parser); }
+t_ast *parser_parse(t_parser *parser) {
+  parser_skip_newlines(parser);
+  if (parser_is_at(parser, 1 << TOKEN_EOF)) return NULL;
 
-t_ast *parser_parse(t_parser *parser) { return parser_parse_list(parser); }
+  t_ast *ast = parser_parse_list(parser);
 
-t_ast *parser_parse_list(t_parser *parser) {
-  t_ast *left = parser_parse_and_or(parser);
-  if (!parser_is_at(parser, 1 << TOKEN_SEMI)) {
-    return left;
+  if (!parser->has_error &&
+      !parser_is_at(parser, (1 << TOKEN_NEWLINE) | (1 << TOKEN_EOF))) {
+    parser_error(parser);
   }
 
-  parser_advance(parser);
-  if (parser_is_at(parser, (1 << TOKEN_SEMI) | (1 << TOKEN_AND_IF) |
-                               (1 << TOKEN_OR_IF) | (1 << TOKEN_PIPE))) {
-    parser_error(parser);
-    return NULL;
+  // Partial trees live in the arena, so they are simply dropped on errors.
+  if (parser->has_error) return NULL;
+  return ast;
+}
+
+t_ast *parser_parse_list(t_parser *parser) {
+  size_t base = parser->nodes.size;
+
+  while (!parser->has_error) {
+    t_ast *and_or = parser_parse_and_or(parser);
+
+    // `&` runs the and-or chain before it asynchronously
+    if (!parser->has_error && parser_is_at(parser, 1 << TOKEN_AMP)) {
+      and_or = ast_new(parser->arena, (t_ast){
+          AST_BACKGROUND,
+          .background.command = and_or,
+      });
+    }
+
+    parser_push(parser, &parser->nodes, and_or);
+    if (parser_is_at(parser, (1 << TOKEN_SEMI) | (1 << TOKEN_AMP))) {
+      parser_advance(parser);
+    } else if (!parser->depth || !parser_is_at(parser, 1 << TOKEN_NEWLINE)) {
+      break;
+    }
+
+    // Inside parentheses, newlines separate commands like `;` does
+    if (parser->depth) parser_skip_newlines(parser);
+    if (parser_is_at(parser, (1 << TOKEN_NEWLINE) | (1 << TOKEN_EOF) |
+                                 (1 << TOKEN_RPAREN))) {
+      break;
+    }
   }
 
-  t_ast *right = parser_parse_list(parser);
+  size_t count = parser->nodes.size - base;
+  if (count == 1) return parser_collect_nodes(parser, base)[0];
 
-  return ast_new((t_ast){
+  return ast_new(parser->arena, (t_ast){
       AST_LIST,
-      .list.left = left,
-      .list.right = right,
+      .list.children = parser_collect_nodes(parser, base),
+      .list.count = count,
   });
 }
 
 t_ast *parser_parse_and_or(t_parser *parser) {
-  t_ast *left = parser_parse_pipe_sequence(parser);
-  if (!parser_is_at(parser, (1 << TOKEN_AND_IF) | (1 << TOKEN_OR_IF))) {
-    return left;
+  size_t base = parser->nodes.size;
+  size_t ops_base = parser->ops.size;
+
+  parser_push(parser, &parser->ops, NULL);
+  parser_push(parser, &parser->nodes, parser_parse_pipe_sequence(parser));
+  while (!parser->has_error &&
+         parser_is_at(parser, (1 << TOKEN_AND_IF) | (1 << TOKEN_OR_IF))) {
+    parser_push(parser, &parser->ops, parser->current_token);
+    parser_advance(parser);
+    parser_skip_newlines(parser);
+    parser_push(parser, &parser->nodes, parser_parse_pipe_sequence(parser));
   }
 
-  t_token *op = parser->current_token;
-  parser_advance(parser);
-  if (parser_is_at(parser, (1 << TOKEN_AND_IF) | (1 << TOKEN_OR_IF) |
-                               (1 << TOKEN_PIPE))) {
-    parser_error(parser);
-    return NULL;
-  }
-  t_ast *right = parser_parse_and_or(parser);
+  size_t count = parser->nodes.size - base;
+  const t_token **ops = parser_collect_ops(parser, ops_base);
+  if (count == 1) return parser_collect_nodes(parser, base)[0];
 
-  return ast_new((t_ast){
+  return ast_new(parser->arena, (t_ast){
       AST_AND_OR,
-      .and_or.left = left,
-      .and_or.op = op,
-      .and_or.right = right,
+      .and_or.children = parser_collect_nodes(parser, base),
+      .and_or.ops = ops,
+      .and_or.count = count,
   });
 }
 
 t_ast *parser_parse_pipe_sequence(t_parser *parser) {
-  t_ast *left = parser_parse_simple_command(parser);
-  if (!parser_is_at(parser, 1 << TOKEN_PIPE)) {
-    return left;
-  }
+  size_t base = parser->nodes.size;
+  t_ast_timing timing = parser_parse_timing(parser);
 
-  parser_advance(parser);
-  if (parser_is_at(parser, (1 << TOKEN_AND_IF) | (1 << TOKEN_OR_IF) |
-                               (1 << TOKEN_PIPE))) {
-    parser_error(parser);
-    return NULL;
+  parser_push(parser, &parser->nodes, parser_parse_simple_command(parser));
+  while (!parser->has_error && parser_is_at(parser, 1 << TOKEN_PIPE)) {
+    parser_advance(parser);
+    parser_skip_newlines(parser);
+    parser_push(parser, &parser->nodes, parser_parse_simple_command(parser));
   }
 
-  t_ast *right = parser_parse_pipe_sequence(parser);
+  size_t count = parser->nodes.size - base;
+  if (count == 1 && timing == AST_TIMING_NONE) {
+    return parser_collect_nodes(parser, base)[0];
+  }
 
-  return ast_new((t_ast){
+  return ast_new(parser->arena, (t_ast){
       AST_PIPE_SEQUENCE,
-      .pipe_sequence.left = left,
-      .pipe_sequence.right = right,
+      .pipe_sequence.children = parser_collect_nodes(parser, base),
+      .pipe_sequence.count = count,
+      .pipe_sequence.timing = timing,
   });
 }
 
+t_ast_timing parser_parse_timing(t_parser *parser) {
+  // Only an unquoted `time` opening the pipeline is the reserved word
+  if (!parser_is_at(parser, 1 << TOKEN_WORD) ||
+      parser->current_token->quoted ||
+      strcmp(parser->current_token->literal, "time") != 0) {
+    return AST_TIMING_NONE;
+  }
+
+  parser_advance(parser);
+  if (parser_is_at(parser, 1 << TOKEN_WORD) &&
+      strcmp(parser->current_token->literal, "-j") == 0) {
+    parser_advance(parser);
+    return AST_TIMING_JSON;
+  }
+  return AST_TIMING_TEXT;
+}
+
 t_ast *parser_parse_subshell(t_parser *parser) {
-  t_ast *subshell = parser_parse_and_or(parser);
+  ++parser->depth;
+  parser_skip_newlines(parser);
+  t_ast *list = parser_parse_list(parser);
+  --parser->depth;
+  if (parser->has_error) return NULL;
+
   if (!parser_is_at(parser, 1 << TOKEN_RPAREN)) {
     parser_error(parser);
     return NULL;
   }
 
   parser_advance(parser);
-  if (parser_is_at(parser, (1 << TOKEN_LPAREN) | (1 << TOKEN_RPAREN) |
-                               (1 << TOKEN_WORD))) {
+  if (parser_is_at(parser, (1 << TOKEN_LPAREN) | (1 << TOKEN_WORD))) {
     parser_error(parser);
     return NULL;
   }
 
-  return ast_new((t_ast){
+  return ast_new(parser->arena, (t_ast){
       AST_SUBSHELL,
-      .subshell.and_or = subshell,
+      .subshell.list = list,
   });
 }
 
@@ -120,97 +173,166 @@ t_ast *parser_parse_simple_command(t_parser *parser) {
     return parser_parse_subshell(parser);
   }
 
-  t_ast *cmd_prefix = parser_parse_cmd_prefix(parser);
-  t_string cmd_name = (t_string)parser->current_token->literal;
-  parser_advance(parser);
-  t_ast *cmd_suffix = parser_parse_cmd_suffix(parser);
-
-  return ast_new((t_ast){
-      AST_SIMPLE_COMMAND,
-      .simple_command.cmd_prefix = cmd_prefix,
-      .simple_command.cmd_name = cmd_name,
-      .simple_command.cmd_suffix = cmd_suffix,
-  });
-}
+  size_t words_base = parser->words.size;
+  size_t expansions_base = parser->expansions.size;
+  size_t redirects_base = parser->redirects.size;
+
+  while (!parser->has_error) {
+    if (parser_is_at(parser, 1 << TOKEN_WORD)) {
+      parser_push(parser, &parser->words, parser->current_token->literal);
+      parser_push(parser, &parser->expansions,
+                  parser->current_token->expansion);
+      parser_advance(parser);
+    } else if (!parser_parse_io_file(parser)) {
+      break;
+    }
+  }
+  if (parser->has_error) return NULL;
 
-t_ast *parser_parse_cmd_prefix(t_parser *parser) {
-  t_ast *io_file = parser_parse_io_file(parser);
-  if (!io_file) {
+  size_t argc = parser->words.size - words_base;
+  size_t io_file_count =
+      (parser->redirects.size - redirects_base) / PARSER_REDIRECT_ITEMS;
+  if (argc == 0 && io_file_count == 0) {
+    parser_error(parser);
     return NULL;
   }
 
-  t_ast *cmd_prefix = parser_parse_cmd_prefix(parser);
-  return ast_new((t_ast){
-      AST_CMD_PREFIX,
-      .cmd_prefix.io_file = io_file,
-      .cmd_prefix.cmd_prefix = cmd_prefix,
+  return ast_new(parser->arena, (t_ast){
+      AST_SIMPLE_COMMAND,
+      .simple_command.argv = parser_collect_words(parser, words_base),
+      .simple_command.argc = argc,
+      .simple_command.expansions =
+          parser_collect_expansions(parser, expansions_base),
+      .simple_command.io_files =
+          parser_collect_io_files(parser, redirects_base),
+      .simple_command.io_file_count = io_file_count,
   });
 }
 
-t_ast *parser_parse_cmd_suffix(t_parser *parser) {
-  t_ast *io_file = parser_parse_io_file(parser);
-  if (io_file) {
-    t_ast *cmd_suffix = parser_parse_cmd_suffix(parser);
-    return ast_new((t_ast){
-        AST_CMD_SUFFIX,
-        .cmd_suffix.io_file = io_file,
-        .cmd_suffix.word = NULL,
-        .cmd_suffix.cmd_suffix = cmd_suffix,
-    });
+bool parser_parse_io_file(t_parser *parser) {
+  if (!parser_is_at(parser, (1 << TOKEN_LESS) | (1 << TOKEN_GREAT) |
+                                (1 << TOKEN_DLESS) | (1 << TOKEN_DGREAT))) {
+    return false;
   }
 
+  const t_token *op = parser->current_token;
+
+  parser_advance(parser);
   if (!parser_is_at(parser, 1 << TOKEN_WORD)) {
-    return NULL;
+    parser_error(parser);
+    return false;
   }
 
-  const char *word = parser->current_token->literal;
+  parser_push(parser, &parser->redirects, op);
+  parser_push(parser, &parser->redirects, parser->current_token->literal);
+  parser_push(parser, &parser->redirects, parser->current_token->expansion);
+  parser_push(parser, &parser->redirects,
+              parser->current_token->quoted ? parser->current_token->literal
+                                            : NULL);
   parser_advance(parser);
-  t_ast *cmd_suffix = parser_parse_cmd_suffix(parser);
-
-  return ast_new((t_ast){
-      AST_CMD_SUFFIX,
-      .cmd_suffix.io_file = NULL,
-      .cmd_suffix.word = word,
-      .cmd_suffix.cmd_suffix = cmd_suffix,
-  });
+  return true;
 }
 
-t_ast *parser_parse_io_file(t_parser *parser) {
-  if (!parser_is_at(parser, (1 << TOKEN_LESS) | (1 << TOKEN_GREAT) |
-                                (1 << TOKEN_DLESS) | (1 << TOKEN_DGREAT))) {
-    return NULL;
+void parser_push(t_parser *parser, t_parser_stack *stack, const void *item) {
+  if (stack->size == stack->capacity) {
+    size_t capacity = stack->capacity ? stack->capacity * 2 : 16;
+    const void **items = arena_alloc(parser->arena, capacity * sizeof(void *));
+    for (size_t i = 0; i < stack->size; ++i) items[i] = stack->items[i];
+    stack->items = items;
+    stack->capacity = capacity;
   }
+  stack->items[stack->size++] = item;
+}
 
-  t_token *op = parser->current_token;
+t_ast **parser_collect_nodes(t_parser *parser, size_t base) {
+  size_t count = parser->nodes.size - base;
+  t_ast **nodes = arena_alloc(parser->arena, count * sizeof(t_ast *));
 
-  parser_advance(parser);
-  if (!parser_is_at(parser, 1 << TOKEN_WORD)) {
-    parser_error(parser);
-    return NULL;
+  for (size_t i = 0; i < count; ++i) {
+    nodes[i] = (t_ast *)parser->nodes.items[base + i];
   }
+  parser->nodes.size = base;
+  return nodes;
+}
 
-  const char *filename = parser->current_token->literal;
-  parser_advance(parser);
+const t_token **parser_collect_ops(t_parser *parser, size_t base) {
+  size_t count = parser->ops.size - base;
+  const t_token **ops = arena_alloc(parser->arena, count * sizeof(t_token *));
 
-  return ast_new((t_ast){
-      AST_IO_FILE,
-      .io_file.op = op,
-      .io_file.filename = filename,
-  });
+  for (size_t i = 0; i < count; ++i) ops[i] = parser->ops.items[base + i];
+  parser->ops.size = base;
+  return ops;
+}
+
+const char **parser_collect_words(t_parser *parser, size_t base) {
+  size_t count = parser->words.size - base;
+  const char **words = arena_alloc(parser->arena, (count + 1) * sizeof(char *));
+
+  for (size_t i = 0; i < count; ++i) words[i] = parser->words.items[base + i];
+  words[count] = NULL;
+  parser->words.size = base;
+  return words;
+}
+
+const t_word_expansion **parser_collect_expansions(t_parser *parser,
+                                                   size_t base) {
+  size_t count = parser->expansions.size - base;
+  const t_word_expansion **expansions = NULL;
+
+  // Commands whose words are all used as written need no array at all
+  for (size_t i = 0; i < count && !expansions; ++i) {
+    if (parser->expansions.items[base + i]) {
+      expansions = arena_alloc(parser->arena, count * sizeof(void *));
+    }
+  }
+  for (size_t i = 0; i < count && expansions; ++i) {
+    expansions[i] = parser->expansions.items[base + i];
+  }
+  parser->expansions.size = base;
+  return expansions;
+}
+
+t_io_file *parser_collect_io_files(t_parser *parser, size_t base) {
+  size_t count = (parser->redirects.size - base) / PARSER_REDIRECT_ITEMS;
+  t_io_file *io_files = arena_alloc(parser->arena, count * sizeof(t_io_file));
+  const void **items = parser->redirects.items + base;
+
+  for (size_t i = 0; i < count; ++i) {
+    io_files[i] = (t_io_file){
+        .op = items[PARSER_REDIRECT_ITEMS * i],
+        .filename = items[PARSER_REDIRECT_ITEMS * i + 1],
+        .expansion = items[PARSER_REDIRECT_ITEMS * i + 2],
+        .fd = -1,
+        .quoted = items[PARSER_REDIRECT_ITEMS * i + 3] != NULL,
+    };
+  }
+  parser->redirects.size = base;
+  return io_files;
 }
 
 void parser_advance(t_parser *parser) {
-  parser->current_token = parser->peek_token;
-  parser->peek_token = lexer_next_token(parser->lexer);
-  token_print(parser->peek_token);
+  parser->current_token = lexer_next_token(parser->lexer);
+#ifdef MINISHELL_DEBUG
+  token_print(parser->current_token);
+#endif
+}
+
+void parser_skip_newlines(t_parser *parser) {
+  while (parser_is_at(parser, 1 << TOKEN_NEWLINE)) parser_advance(parser);
 }
 
 bool parser_is_at(t_parser *parser, t_token_type token_type) {
   return (1 << parser->current_token->type) & token_type;
 }
 
+bool parser_has_error(const t_parser *parser) { return parser->has_error; }
+
 void parser_error(t_parser *parser) {
   parser->has_error = true;
+  if (parser_is_at(parser, 1 << TOKEN_EOF)) {
+    fprintf(stderr, MINISHELL_NAME ": syntax error: unexpected end of file\n");
+    return;
+  }
   fprintf(stderr, MINISHELL_NAME ": syntax error near unexpected token `%s'\n",
           parser->current_token->literal);
 }
@@ -1,13 +1,119 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "arena/arena.h"
 #include "ast/ast.h"
 #include "lexer/lexer.h"
 
 typedef struct s_parser t_parser;
 
-t_parser *parser_new(t_lexer *lexer);
-void parser_free(t_parser *parser);
+t_parser *parser_new(t_arena *arena, t_lexer *lexer);
+
+/**
+ * @brief Parses the next complete command into an AST allocated from the
+ * parser's arena.
+ *
+ * The command ends at the first newline that does not continue it; newlines
+ * after `&&`, `||` and `|` or inside parentheses do. Blank lines before it
+ * are skipped, and the lexer is left at the start of the line after it.
+ *
+ * @return The AST, or NULL at the end of the input or on a syntax error.
+ */
 t_ast *parser_parse(t_parser *parser);
 
+/**
+ * @brief Tells a syntax error apart from the end of the input after
+ * `parser_parse` returned NULL.
+ */
+bool parser_has_error(const t_parser *parser);
+
+/**
+ * @brief Size of the chunks of the arena a tree is parsed into when it may be
+ * cached; the unused tail of the last one is wasted while it is.
+ */
+#define PARSER_CACHE_CHUNK_SIZE 1024
+
+/**
+ * @brief A tree kept by the parse cache, pinned while it is in use.
+ */
+typedef struct s_parser_cache_entry t_parser_cache_entry;
+
+/**
+ * @brief Counters of the parse cache, to tune its capacity.
+ *
+ * `size` and `capacity` are in bytes.
+ */
+typedef struct s_parser_cache_stats {
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+  size_t entries;
+  size_t size;
+  size_t capacity;
+} t_parser_cache_stats;
+
+/**
+ * @brief Looks up the tree parsed from `line`, ignoring leading and
+ * trailing blanks, and pins it.
+ *
+ * On a miss, `*admit` tells whether the tree is worth caching: the line was
+ * missed before, has no here-document and the cache is on.
+ *
+ * @return The entry, to release once the tree has run, or NULL on a miss.
+ */
+t_parser_cache_entry *parser_cache_acquire(const char *line, size_t length,
+                                           bool *admit);
+
+/**
+ * @brief Checks whether an entry of `size` bytes fits in the cache at all.
+ */
+bool parser_cache_fits(size_t size);
+
+/**
+ * @brief Caches `ast`, parsed from `line` alone into `arena`, and pins it.
+ *
+ * `data` is anything derived from the tree and allocated from `arena` too,
+ * such as its compiled program. Trees with here-documents are never cached:
+ * collecting their bodies writes to them.
+ *
+ * Entries are charged the memory `arena` handed out.
+ *
+ * @return The entry, which now owns `arena`, or NULL if the tree was not
+ * cached and `arena` still belongs to the caller.
+ */
+t_parser_cache_entry *parser_cache_insert(const char *line, size_t length,
+                                          const t_ast *ast, const void *data,
+                                          t_arena *arena);
+
+/**
+ * @brief Returns the tree of `entry`, which is shared and must not change.
+ */
+const t_ast *parser_cache_ast(const t_parser_cache_entry *entry);
+
+/**
+ * @brief Returns the data cached along with the tree of `entry`.
+ */
+const void *parser_cache_data(const t_parser_cache_entry *entry);
+
+/**
+ * @brief Unpins `entry`; it may be evicted from then on.
+ */
+void parser_cache_release(t_parser_cache_entry *entry);
+
+t_parser_cache_stats parser_cache_stats(void);
+
+/**
+ * @brief Drops every tree, forgets the lines seen and resets the counters.
+ */
+void parser_cache_clear(void);
+
+/**
+ * @brief Sets the memory the cached trees may use, evicting the least
+ * recently used ones above it; 0 turns the cache off.
+ */
+void parser_cache_resize(size_t capacity);
+
 #endif
@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena/arena.h"
+#include "ft_stdlib.h"
+#include "parser.h"
+#include "parser_internal.h"
+
+/**
+ * @brief Returns the cache shared by every line the shell runs.
+ */
+static t_parser_cache *parser_cache(void) {
+  static t_parser_cache cache = {.buckets = NULL};
+
+  if (!cache.buckets) {
+    cache.buckets = ft_expect(
+        calloc(PARSER_CACHE_BUCKETS, sizeof(t_parser_cache_entry *)),
+        __func__);
+    cache.seen =
+        ft_expect(calloc(PARSER_CACHE_SEEN, sizeof(uint64_t)), __func__);
+    cache.mask = PARSER_CACHE_BUCKETS - 1;
+    cache.capacity = PARSER_CACHE_CAPACITY;
+  }
+  return &cache;
+}
+
+/**
+ * @brief Strips the blanks around `*line` that cannot change its meaning.
+ *
+ * Leading blanks never do. Trailing ones could be quoted or escaped, so
+ * they are only stripped from lines without quotes or backslashes.
+ */
+static void parser_cache_normalize(const char **line, size_t *length) {
+  while (*length > 0 && (**line == ' ' || **line == '\t')) {
+    ++*line;
+    --*length;
+  }
+  if (memchr(*line, '\'', *length) || memchr(*line, '"', *length) ||
+      memchr(*line, '\\', *length)) {
+    return;
+  }
+  while (*length > 0 &&
+         ((*line)[*length - 1] == ' ' || (*line)[*length - 1] == '\t')) {
+    --*length;
+  }
+}
+
+/**
+ * @brief Checks whether `line` has a here-document, whose body is collected
+ * into its tree.
+ */
+static bool parser_cache_has_heredoc(const char *line, size_t length) {
+  for (const char *less = line;
+       (less = memchr(less, '<', length - (size_t)(less - line)));) {
+    if (++less < line + length && *less == '<') return true;
+  }
+  return false;
+}
+
+static uint64_t parser_cache_hash(const char *line, size_t length) {
+  uint64_t hash = 0xcbf29ce484222325u;
+
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ (unsigned char)line[i]) * 0x100000001b3u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Moves `entry` to the most recently used end of the list.
+ */
+static void parser_cache_touch(t_parser_cache *cache,
+                               t_parser_cache_entry *entry) {
+  if (cache->newest == entry) return;
+
+  // Unlink, unless it is not in the list yet
+  if (entry->newer) entry->newer->older = entry->older;
+  if (entry->older) entry->older->newer = entry->newer;
+  if (cache->oldest == entry) cache->oldest = entry->newer;
+
+  entry->newer = NULL;
+  entry->older = cache->newest;
+  if (cache->newest) cache->newest->newer = entry;
+  cache->newest = entry;
+  if (!cache->oldest) cache->oldest = entry;
+}
+
+/**
+ * @brief Removes `entry` from the buckets and the list, and frees it unless
+ * it is pinned.
+ */
+static void parser_cache_drop(t_parser_cache *cache,
+                              t_parser_cache_entry *entry) {
+  t_parser_cache_entry **link = &cache->buckets[entry->hash & cache->mask];
+
+  while (*link != entry) link = &(*link)->chain;
+  *link = entry->chain;
+
+  if (entry->newer) {
+    entry->newer->older = entry->older;
+  } else {
+    cache->newest = entry->older;
+  }
+  if (entry->older) {
+    entry->older->newer = entry->newer;
+  } else {
+    cache->oldest = entry->newer;
+  }
+
+  --cache->count;
+  cache->size -= entry->size;
+  if (entry->users > 0) {
+    entry->detached = true;
+  } else {
+    arena_free(entry->arena);
+  }
+}
+
+/**
+ * @brief Evicts the least recently used entries not in use until the cache
+ * fits in its capacity.
+ */
+static void parser_cache_evict(t_parser_cache *cache) {
+  t_parser_cache_entry *entry = cache->oldest;
+
+  while (entry && cache->size > cache->capacity) {
+    t_parser_cache_entry *newer = entry->newer;
+    if (entry->users == 0) {
+      parser_cache_drop(cache, entry);
+      ++cache->evictions;
+    }
+    entry = newer;
+  }
+}
+
+/**
+ * @brief Doubles the buckets once there are more entries than buckets.
+ */
+static void parser_cache_grow(t_parser_cache *cache) {
+  if (cache->count <= cache->mask + 1) return;
+
+  size_t count = (cache->mask + 1) * 2;
+  t_parser_cache_entry **buckets =
+      ft_expect(calloc(count, sizeof(t_parser_cache_entry *)), __func__);
+  for (size_t i = 0; i <= cache->mask; ++i) {
+    t_parser_cache_entry *entry = cache->buckets[i];
+    while (entry) {
+      t_parser_cache_entry *chain = entry->chain;
+      entry->chain = buckets[entry->hash & (count - 1)];
+      buckets[entry->hash & (count - 1)] = entry;
+      entry = chain;
+    }
+  }
+  free(cache->buckets);
+  cache->buckets = buckets;
+  cache->mask = count - 1;
+}
+
+static t_parser_cache_entry *parser_cache_find(const t_parser_cache *cache,
+                                               const char *line,
+                                               size_t length, uint64_t hash) {
+  t_parser_cache_entry *entry = cache->buckets[hash & cache->mask];
+
+  while (entry && (entry->hash != hash || entry->length != length ||
+                   memcmp(entry->key, line, length) != 0)) {
+    entry = entry->chain;
+  }
+  return entry;
+}
+
+t_parser_cache_entry *parser_cache_acquire(const char *line, size_t length,
+                                           bool *admit) {
+  t_parser_cache *cache = parser_cache();
+
+  parser_cache_normalize(&line, &length);
+  uint64_t hash = parser_cache_hash(line, length);
+  t_parser_cache_entry *entry = parser_cache_find(cache, line, length, hash);
+  if (!entry) {
+    ++cache->misses;
+
+    // A first sighting is only remembered, in place of any older one
+    uint64_t *seen = &cache->seen[hash & (PARSER_CACHE_SEEN - 1)];
+    *admit = *seen == hash && cache->capacity > 0 &&
+             !parser_cache_has_heredoc(line, length);
+    *seen = hash;
+    return NULL;
+  }
+
+  ++cache->hits;
+  ++entry->users;
+  parser_cache_touch(cache, entry);
+  return entry;
+}
+
+t_parser_cache_entry *parser_cache_insert(const char *line, size_t length,
+                                          const t_ast *ast, const void *data,
+                                          t_arena *arena) {
+  t_parser_cache *cache = parser_cache();
+
+  parser_cache_normalize(&line, &length);
+  if (parser_cache_has_heredoc(line, length)) return NULL;
+
+  uint64_t hash = parser_cache_hash(line, length);
+  if (parser_cache_find(cache, line, length, hash)) return NULL;
+
+  t_parser_cache_entry *entry = arena_calloc(arena, sizeof(*entry));
+  char *key = arena_alloc(arena, length);
+  memcpy(key, line, length);
+  *entry = (t_parser_cache_entry){
+      .hash = hash,
+      .key = key,
+      .length = length,
+      .ast = ast,
+      .data = data,
+      .arena = arena,
+      .size = arena_used(arena),
+      .users = 1,
+  };
+  if (entry->size > cache->capacity) return NULL;
+
+  entry->chain = cache->buckets[hash & cache->mask];
+  cache->buckets[hash & cache->mask] = entry;
+  parser_cache_touch(cache, entry);
+  ++cache->count;
+  cache->size += entry->size;
+  parser_cache_grow(cache);
+  parser_cache_evict(cache);
+  return entry;
+}
+
+bool parser_cache_fits(size_t size) {
+  return size <= parser_cache()->capacity;
+}
+
+const t_ast *parser_cache_ast(const t_parser_cache_entry *entry) {
+  return entry->ast;
+}
+
+const void *parser_cache_data(const t_parser_cache_entry *entry) {
+  return entry->data;
+}
+
+void parser_cache_release(t_parser_cache_entry *entry) {
+  --entry->users;
+  if (entry->detached && entry->users == 0) {
+    arena_free(entry->arena);
+  } else {
+    parser_cache_evict(parser_cache());
+  }
+}
+
+t_parser_cache_stats parser_cache_stats(void) {
+  const t_parser_cache *cache = parser_cache();
+
+  return (t_parser_cache_stats){
+      .hits = cache->hits,
+      .misses = cache->misses,
+      .evictions = cache->evictions,
+      .entries = cache->count,
+      .size = cache->size,
+      .capacity = cache->capacity,
+  };
+}
+
+void parser_cache_clear(void) {
+  t_parser_cache *cache = parser_cache();
+
+  while (cache->oldest) parser_cache_drop(cache, cache->oldest);
+  memset(cache->seen, 0, PARSER_CACHE_SEEN * sizeof(uint64_t));
+  cache->hits = 0;
+  cache->misses = 0;
+  cache->evictions = 0;
+}
+
+void parser_cache_resize(size_t capacity) {
+  t_parser_cache *cache = parser_cache();
+
+  cache->capacity = capacity;
+  parser_cache_evict(cache);
+}
@@ -2,28 +2,124 @@
 #define PARSER_INTERNAL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+#include "arena/arena.h"
 #include "ast/ast.h"
 #include "lexer/lexer.h"
 #include "parser.h"
 #include "token/token.h"
 
+/**
+ * @brief Scratch stack the iterative parsing loops collect operands on.
+ *
+ * Nested constructs push above their parent's operands and pop back to their
+ * own base, so one stack serves every level.
+ */
+typedef struct s_parser_stack {
+  const void **items;
+  size_t size;
+  size_t capacity;
+} t_parser_stack;
+
+/**
+ * @brief Items a redirection takes on the `redirects` stack: its operator,
+ * its filename, the filename's expansion, and the filename again if it was
+ * quoted or NULL otherwise.
+ */
+#define PARSER_REDIRECT_ITEMS 4
+
+/**
+ * @brief Memory the parse cache may use by default, in bytes.
+ */
+#define PARSER_CACHE_CAPACITY (4 << 20)
+
+/**
+ * @brief Initial number of buckets of the parse cache; doubled whenever it
+ * holds more entries than buckets.
+ */
+#define PARSER_CACHE_BUCKETS 64
+
+/**
+ * @brief Number of lines whose first sighting the parse cache remembers; a
+ * power of two.
+ */
+#define PARSER_CACHE_SEEN 4096
+
+/**
+ * @brief A cached tree, allocated with its key from the arena it owns.
+ *
+ * Entries are chained in their bucket through `chain`, and in a list from
+ * the most to the least recently used through `newer` and `older`. An entry
+ * dropped while pinned is `detached` and freed when its last user releases
+ * it.
+ */
+struct s_parser_cache_entry {
+  struct s_parser_cache_entry *chain;
+  struct s_parser_cache_entry *newer;
+  struct s_parser_cache_entry *older;
+  uint64_t hash;
+  const char *key;
+  size_t length;
+  const t_ast *ast;
+  const void *data;
+  t_arena *arena;
+  size_t size;
+  size_t users;
+  bool detached;
+};
+
+/**
+ * @brief The parse cache.
+ *
+ * `seen` holds the hashes of lines missed once, each in the slot its low
+ * bits pick; a line is only cached when it is missed again, so that scripts
+ * of distinct lines do not pay for entries never hit.
+ */
+typedef struct s_parser_cache {
+  t_parser_cache_entry **buckets;
+  uint64_t *seen;
+  size_t mask;
+  t_parser_cache_entry *newest;
+  t_parser_cache_entry *oldest;
+  size_t count;
+  size_t size;
+  size_t capacity;
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+} t_parser_cache;
+
 struct s_parser {
+  t_arena *arena;
   t_lexer *lexer;
-  t_token *current_token;
-  t_token *peek_token;
+  const t_token *current_token;
   bool has_error;
+  size_t depth;
+  t_parser_stack nodes;
+  t_parser_stack ops;
+  t_parser_stack words;
+  t_parser_stack expansions;
+  t_parser_stack redirects;
 };
 
 t_ast *parser_parse_list(t_parser *parser);
 t_ast *parser_parse_and_or(t_parser *parser);
 t_ast *parser_parse_pipe_sequence(t_parser *parser);
+t_ast_timing parser_parse_timing(t_parser *parser);
 t_ast *parser_parse_subshell(t_parser *parser);
 t_ast *parser_parse_simple_command(t_parser *parser);
-t_ast *parser_parse_cmd_prefix(t_parser *parser);
-t_ast *parser_parse_cmd_suffix(t_parser *parser);
-t_ast *parser_parse_io_file(t_parser *parser);
+bool parser_parse_io_file(t_parser *parser);
+void parser_push(t_parser *parser, t_parser_stack *stack, const void *item);
+t_ast **parser_collect_nodes(t_parser *parser, size_t base);
+const t_token **parser_collect_ops(t_parser *parser, size_t base);
+const char **parser_collect_words(t_parser *parser, size_t base);
+const t_word_expansion **parser_collect_expansions(t_parser *parser,
+                                                   size_t base);
+t_io_file *parser_collect_io_files(t_parser *parser, size_t base);
 void parser_advance(t_parser *parser);
+void parser_skip_newlines(t_parser *parser);
 bool parser_is_at(t_parser *parser, t_token_type type);
 void parser_error(t_parser *parser);
 
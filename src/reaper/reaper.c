@@ -0,0 +1,316 @@
+#define _GNU_SOURCE
+
+#include "reaper.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ft_stdlib.h"
+#include "minishell.h"
+#include "reaper_internal.h"
+
+t_reaper *reaper_instance(void) {
+  static t_reaper reaper = {.owner = 0};
+
+  if (reaper.owner != getpid()) reaper_init(&reaper);
+  return &reaper;
+}
+
+void reaper_init(t_reaper *reaper) {
+  // State inherited from the parent shell refers to the parent's children
+  if (reaper->owner != 0) {
+    close(reaper->epoll_fd);
+    if (reaper->signal_fd != -1) close(reaper->signal_fd);
+    for (size_t i = 0; i < reaper->count; ++i) {
+      if (reaper->children[i].pidfd != -1) close(reaper->children[i].pidfd);
+    }
+    free(reaper->children);
+    free(reaper->slots);
+  } else {
+    sigprocmask(SIG_BLOCK, NULL, &reaper->exec_mask);
+  }
+
+  reaper->owner = getpid();
+  reaper->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (reaper->epoll_fd == -1) ft_panic(__func__);
+  reaper->signal_fd = -1;
+  reaper->input_fd = -1;
+  reaper->input_pollable = false;
+  reaper->children = NULL;
+  reaper->count = 0;
+  reaper->capacity = 0;
+  reaper->slots = NULL;
+  reaper->slot_mask = 0;
+  reaper->ready = 0;
+}
+
+/**
+ * @brief Falls back to `SIGCHLD`, delivered through a signalfd.
+ *
+ * @return false if the fallback is not available either.
+ */
+bool reaper_use_signals(t_reaper *reaper) {
+  sigset_t child_signal;
+
+  if (reaper->signal_fd != -1) return true;
+
+  sigemptyset(&child_signal);
+  sigaddset(&child_signal, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &child_signal, NULL);
+  reaper->signal_fd =
+      signalfd(-1, &child_signal, SFD_CLOEXEC | SFD_NONBLOCK);
+  if (reaper->signal_fd == -1) return false;
+
+  struct epoll_event event = {.events = EPOLLIN,
+                              .data.u64 = REAPER_EVENT_SIGNAL};
+  return epoll_ctl(reaper->epoll_fd, EPOLL_CTL_ADD, reaper->signal_fd,
+                   &event) != -1;
+}
+
+void reaper_watch(pid_t pid) {
+  t_reaper *reaper = reaper_instance();
+
+  if (!reaper_find(reaper, pid)) reaper_add(reaper, pid);
+}
+
+static size_t reaper_hash(pid_t pid) {
+  return (size_t)((uint32_t)pid * 2654435761u);
+}
+
+/**
+ * @brief Returns the slot of the index holding `pid`, or the free slot it
+ * would go to.
+ */
+static size_t *reaper_slot(const t_reaper *reaper, pid_t pid) {
+  size_t i = reaper_hash(pid) & reaper->slot_mask;
+
+  while (reaper->slots[i] &&
+         reaper->children[reaper->slots[i] - 1].pid != pid) {
+    i = (i + 1) & reaper->slot_mask;
+  }
+  return &reaper->slots[i];
+}
+
+/**
+ * @brief Doubles the index once it would get more than half full.
+ */
+static void reaper_grow_index(t_reaper *reaper) {
+  size_t size = reaper->slots ? reaper->slot_mask + 1 : 0;
+
+  if (2 * (reaper->count + 1) <= size) return;
+
+  size = size ? size * 2 : REAPER_MIN_SLOTS;
+  free(reaper->slots);
+  reaper->slots = ft_expect(calloc(size, sizeof(size_t)), __func__);
+  reaper->slot_mask = size - 1;
+  for (size_t i = 0; i < reaper->count; ++i) {
+    *reaper_slot(reaper, reaper->children[i].pid) = i + 1;
+  }
+}
+
+/**
+ * @brief Frees `slot`, moving back the entries after it that could not take
+ * their own slot, so no lookup stops short of them.
+ */
+static void reaper_unindex(t_reaper *reaper, size_t *slot) {
+  size_t mask = reaper->slot_mask;
+  size_t hole = (size_t)(slot - reaper->slots);
+
+  for (size_t i = (hole + 1) & mask; reaper->slots[i]; i = (i + 1) & mask) {
+    size_t home =
+        reaper_hash(reaper->children[reaper->slots[i] - 1].pid) & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      reaper->slots[hole] = reaper->slots[i];
+      hole = i;
+    }
+  }
+  reaper->slots[hole] = 0;
+}
+
+t_reaper_child *reaper_find(t_reaper *reaper, pid_t pid) {
+  if (!reaper->slots) return NULL;
+
+  size_t index = *reaper_slot(reaper, pid);
+  return index ? &reaper->children[index - 1] : NULL;
+}
+
+t_reaper_child *reaper_add(t_reaper *reaper, pid_t pid) {
+  if (reaper->count == reaper->capacity) {
+    reaper->capacity = reaper->capacity * 2 + 16;
+    reaper->children = ft_expect(
+        realloc(reaper->children, reaper->capacity * sizeof(t_reaper_child)),
+        __func__);
+  }
+  reaper_grow_index(reaper);
+
+  t_reaper_child *child = &reaper->children[reaper->count++];
+  *child = (t_reaper_child){.pid = pid, .pidfd = -1, .exited = false};
+  *reaper_slot(reaper, pid) = reaper->count;
+
+#ifdef SYS_pidfd_open
+  if (reaper->signal_fd == -1) {
+    child->pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+  }
+#else
+  errno = ENOSYS;
+#endif
+
+  if (child->pidfd != -1) {
+    struct epoll_event event = {.events = EPOLLIN, .data.u64 = (uint64_t)pid};
+    epoll_ctl(reaper->epoll_fd, EPOLL_CTL_ADD, child->pidfd, &event);
+  } else if (errno != ESRCH && !reaper_use_signals(reaper)) {
+    perror(MINISHELL_NAME);
+  }
+
+  // It may be gone already; the pidfd or signal would then never come
+  reaper_check(reaper, child);
+  return child;
+}
+
+/**
+ * @brief Collects `child` if it exited.
+ */
+void reaper_check(t_reaper *reaper, t_reaper_child *child) {
+  if (child->exited) return;
+
+  pid_t pid = wait4(child->pid, &child->wait_status, WNOHANG,
+                    &child->usage.rusage);
+  if (pid == 0 || (pid == -1 && errno == EINTR)) return;
+
+  clock_gettime(CLOCK_MONOTONIC, &child->usage.exited_at);
+  // Anything else than a collected child means it is not ours to wait for
+  if (pid == -1) child->wait_status = -1;
+  child->exited = true;
+  if (child->wanted) reaper->ready = child->pid;
+  if (child->pidfd != -1) {
+    close(child->pidfd);
+    child->pidfd = -1;
+  }
+}
+
+/**
+ * @brief Hands what is known of the exited `child` over and drops it.
+ */
+void reaper_forget(t_reaper *reaper, t_reaper_child *child, int *wait_status,
+                   t_reaper_usage *usage) {
+  size_t index = (size_t)(child - reaper->children);
+
+  *wait_status = child->wait_status;
+  if (usage) *usage = child->usage;
+  reaper_unindex(reaper, reaper_slot(reaper, child->pid));
+
+  // The last child fills the gap; its slot still finds it at its old index
+  if (index != --reaper->count) {
+    *child = reaper->children[reaper->count];
+    *reaper_slot(reaper, child->pid) = index + 1;
+  }
+}
+
+bool reaper_dispatch(t_reaper *reaper, int timeout_ms) {
+  struct epoll_event events[REAPER_MAX_EVENTS];
+  bool input_ready = false;
+
+  int count = epoll_wait(reaper->epoll_fd, events, REAPER_MAX_EVENTS,
+                         timeout_ms);
+  for (int i = 0; i < count; ++i) {
+    uint64_t tag = events[i].data.u64;
+    if (tag == REAPER_EVENT_INPUT) {
+      input_ready = true;
+    } else if (tag == REAPER_EVENT_SIGNAL) {
+      // One signal may stand for several children; check them all
+      struct signalfd_siginfo info;
+      while (read(reaper->signal_fd, &info, sizeof(info)) > 0) {
+      }
+      for (size_t k = 0; k < reaper->count; ++k) {
+        reaper_check(reaper, &reaper->children[k]);
+      }
+    } else {
+      t_reaper_child *child = reaper_find(reaper, (pid_t)tag);
+      if (child) reaper_check(reaper, child);
+    }
+  }
+  return input_ready;
+}
+
+int reaper_wait(pid_t pid, t_reaper_usage *usage) {
+  t_reaper *reaper = reaper_instance();
+  int wait_status;
+
+  reaper_watch(pid);
+  while (!reaper_find(reaper, pid)->exited) reaper_dispatch(reaper, -1);
+  reaper_forget(reaper, reaper_find(reaper, pid), &wait_status, usage);
+  return wait_status;
+}
+
+pid_t reaper_wait_any(const pid_t *pids, size_t count, int *wait_status) {
+  t_reaper *reaper = reaper_instance();
+  pid_t pid = 0;
+
+  if (count == 0) return -1;
+
+  // Children that exit from now on report themselves, so each reap costs
+  // one lookup instead of a pass over `pids`
+  for (size_t i = 0; i < count; ++i) {
+    reaper_watch(pids[i]);
+    t_reaper_child *child = reaper_find(reaper, pids[i]);
+    child->wanted = true;
+    if (child->exited && pid == 0) pid = pids[i];
+  }
+  reaper->ready = 0;
+  while (pid == 0) {
+    reaper_dispatch(reaper, -1);
+    pid = reaper->ready;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    reaper_find(reaper, pids[i])->wanted = false;
+  }
+  reaper_forget(reaper, reaper_find(reaper, pid), wait_status, NULL);
+  return pid;
+}
+
+bool reaper_try(pid_t pid, int *wait_status) {
+  t_reaper *reaper = reaper_instance();
+
+  reaper_watch(pid);
+  reaper_dispatch(reaper, 0);
+
+  t_reaper_child *child = reaper_find(reaper, pid);
+  if (!child->exited) return false;
+  reaper_forget(reaper, child, wait_status, NULL);
+  return true;
+}
+
+bool reaper_poll(int fd, int timeout_ms) {
+  t_reaper *reaper = reaper_instance();
+
+  if (reaper->input_fd != fd) {
+    if (reaper->input_pollable) {
+      epoll_ctl(reaper->epoll_fd, EPOLL_CTL_DEL, reaper->input_fd, NULL);
+    }
+    // Regular files cannot be polled, and are always readable anyway
+    struct epoll_event event = {.events = EPOLLIN,
+                                .data.u64 = REAPER_EVENT_INPUT};
+    reaper->input_fd = fd;
+    reaper->input_pollable =
+        epoll_ctl(reaper->epoll_fd, EPOLL_CTL_ADD, fd, &event) != -1;
+  }
+
+  if (!reaper->input_pollable) {
+    reaper_dispatch(reaper, 0);
+    return true;
+  }
+  return reaper_dispatch(reaper, timeout_ms);
+}
+
+const sigset_t *reaper_exec_mask(void) {
+  return &reaper_instance()->exec_mask;
+}
@@ -0,0 +1,70 @@
+#ifndef REAPER_H
+#define REAPER_H
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * @brief What a child used, as reported by `wait4`, and when the shell
+ * collected it on `CLOCK_MONOTONIC`.
+ */
+typedef struct s_reaper_usage {
+  struct rusage rusage;
+  struct timespec exited_at;
+} t_reaper_usage;
+
+/**
+ * @brief Starts watching the child `pid`.
+ *
+ * Children are watched through a pidfd each, or through `SIGCHLD` on
+ * kernels without pidfds, and collected as soon as they exit, whatever the
+ * shell is waiting for at the time. Waiting for a child that is not watched
+ * yet watches it first.
+ */
+void reaper_watch(pid_t pid);
+
+/**
+ * @brief Waits for the child `pid` to exit and forgets it.
+ *
+ * @param usage Receives its resource usage, unless NULL.
+ * @return Its status as reported by `waitpid`, or -1 if it is not a child of
+ * the shell.
+ */
+int reaper_wait(pid_t pid, t_reaper_usage *usage);
+
+/**
+ * @brief Waits for the first of `count` children to exit and forgets it.
+ *
+ * @param wait_status Receives its status as reported by `waitpid`, or -1 if
+ * it is not a child of the shell.
+ * @return Its pid, or -1 if `count` is 0.
+ */
+pid_t reaper_wait_any(const pid_t *pids, size_t count, int *wait_status);
+
+/**
+ * @brief Checks whether the child `pid` exited, without blocking, and
+ * forgets it if so.
+ */
+bool reaper_try(pid_t pid, int *wait_status);
+
+/**
+ * @brief Waits until `fd` is readable or `timeout_ms` milliseconds passed,
+ * collecting every child that exits meanwhile.
+ *
+ * @param timeout_ms The longest wait, or -1 to wait for input only.
+ * @return true if `fd` is readable.
+ */
+bool reaper_poll(int fd, int timeout_ms);
+
+/**
+ * @brief The signal mask new programs should start with.
+ *
+ * The fallback blocks `SIGCHLD` in the shell, which must not be inherited.
+ */
+const sigset_t *reaper_exec_mask(void);
+
+#endif
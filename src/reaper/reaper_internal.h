@@ -0,0 +1,74 @@
+#ifndef REAPER_INTERNAL_H
+#define REAPER_INTERNAL_H
+
+#include <stdint.h>
+
+#include "reaper.h"
+
+/**
+ * @brief Events handled per `epoll_wait` call.
+ */
+#define REAPER_MAX_EVENTS 64
+
+/**
+ * @brief Smallest size of the pid index; it is kept at most half full.
+ */
+#define REAPER_MIN_SLOTS 64
+
+/**
+ * @brief Tags of the events that are not a pidfd, which carry their pid.
+ */
+#define REAPER_EVENT_INPUT UINT64_MAX
+#define REAPER_EVENT_SIGNAL (UINT64_MAX - 1)
+
+/**
+ * @brief A watched child; `pidfd` is -1 once it exited or when pidfds are
+ * not supported. `wanted` marks the children `reaper_wait_any` waits for.
+ */
+typedef struct s_reaper_child {
+  pid_t pid;
+  int pidfd;
+  bool exited;
+  bool wanted;
+  int wait_status;
+  t_reaper_usage usage;
+} t_reaper_child;
+
+/**
+ * @brief The shell's single event loop.
+ *
+ * It belongs to the process that created it: a forked shell starts one of
+ * its own rather than share the parent's epoll instance. `signal_fd` is
+ * only opened when pidfds are not supported, and `input_fd` is the
+ * descriptor last passed to `reaper_poll`, or -1.
+ *
+ * `slots` indexes `children` by pid with open addressing: each holds the
+ * index of a child plus one, or 0 when free. `ready` is the pid of the last
+ * `wanted` child that exited, or 0.
+ */
+typedef struct s_reaper {
+  pid_t owner;
+  int epoll_fd;
+  int signal_fd;
+  int input_fd;
+  bool input_pollable;
+  sigset_t exec_mask;
+  t_reaper_child *children;
+  size_t count;
+  size_t capacity;
+  size_t *slots;
+  size_t slot_mask;
+  pid_t ready;
+} t_reaper;
+
+t_reaper *reaper_instance(void);
+void reaper_init(t_reaper *reaper);
+bool reaper_use_signals(t_reaper *reaper);
+t_reaper_child *reaper_find(t_reaper *reaper, pid_t pid);
+t_reaper_child *reaper_add(t_reaper *reaper, pid_t pid);
+void reaper_check(t_reaper *reaper, t_reaper_child *child);
+void reaper_forget(t_reaper *reaper, t_reaper_child *child, int *wait_status,
+                   t_reaper_usage *usage);
+bool reaper_dispatch(t_reaper *reaper, int timeout_ms);
+
+#endif
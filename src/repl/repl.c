@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "repl.h"
 
 #include <stdio.h>
@@ -7,14 +9,23 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-#include "ast/ast.h"
+#include "arena/arena.h"
 #include "environment/environment.h"
-#include "evaluator/evaluator.h"
-#include "lexer/lexer.h"
+#include "job/job.h"
 #include "minishell.h"
-#include "parser/parser.h"
+#include "reaper/reaper.h"
 #include "repl_internal.h"
+#include "script/script.h"
+
+/**
+ * @brief The line handed over by readline's callback interface.
+ */
+static struct {
+  char *text;
+  bool ready;
+} g_repl_line;
 
 /**
  * @brief Checks if the REPL should continue running based on input.
@@ -27,52 +38,58 @@ static bool should_continue_running(const char *line) {
 }
 
 /**
- * @brief Processes a line of input.
+ * @brief Receives the line readline finished editing.
  *
- * @param input The input string to process.
- * @param environment The environment variables.
+ * The handler is removed before anything else runs, so the line can be
+ * executed, and here-documents read, outside of readline.
  */
-static void process_input(const char *input, t_hashmap *environment) {
-  t_lexer *lexer = lexer_new(input);
-  if (!lexer) {
-    fprintf(stderr, "%s: failed to create lexer\n", MINISHELL_NAME);
-    return;
-  }
+static void handle_line(char *line) {
+  rl_callback_handler_remove();
+  g_repl_line.text = line;
+  g_repl_line.ready = true;
+}
 
-  t_parser *parser = parser_new(lexer);
-  if (!parser) {
-    fprintf(stderr, "%s: failed to create parser\n", MINISHELL_NAME);
-    lexer_free(lexer);
-    return;
+/**
+ * @brief Reads a line with `prompt` while keeping the event loop running.
+ *
+ * Readline is fed one character whenever the terminal is readable, so
+ * background jobs that finish while the user types are collected at once
+ * rather than left as zombies until the next command.
+ *
+ * @return The line, or NULL at end of input.
+ */
+static char *read_line(const char *prompt) {
+  g_repl_line.text = NULL;
+  g_repl_line.ready = false;
+  rl_callback_handler_install(prompt, handle_line);
+  while (!g_repl_line.ready) {
+    if (reaper_poll(fileno(rl_instream ? rl_instream : stdin), -1)) {
+      rl_callback_read_char();
+    }
   }
+  return g_repl_line.text;
+}
 
-  t_ast *ast = parser_parse(parser);
-
-  if (ast) {
-    // Print the AST for debugging purposes
-    ast_print(ast);
-
-    // Evaluate the AST
-    int status = evaluator_evaluate(ast, environment);
-
-    // Optionally store the status in the environment
-    char status_str[16];
-    snprintf(status_str, sizeof(status_str), "%d", status);
-    char key_value[32];
-    snprintf(key_value, sizeof(key_value), "?=%s", status_str);
-    environment_set(environment, key_value);
-
-    ast_free(ast);
-  }
+/**
+ * @brief Reads a line of a here-document body from the terminal.
+ *
+ * `context` holds the line readline returned last, which is lent until this
+ * is called again.
+ */
+static const char *read_heredoc_line(void *context, size_t *length) {
+  char **line = context;
 
-  parser_free(parser);
-  lexer_free(lexer);
+  free(*line);
+  *line = read_line(REPL_HEREDOC_PROMPT);
+  if (*line) *length = strlen(*line);
+  return *line;
 }
 
-void repl_start(t_hashmap *environment) {
+void repl_start(t_environment *environment) {
   char *input;
   char prompt[32];
   bool running = true;
+  t_arena *arena = arena_new(REPL_ARENA_CHUNK_SIZE);
 
   // Set up signal handlers
   repl_setup_signals();
@@ -84,8 +101,11 @@ void repl_start(t_hashmap *environment) {
   read_history(".minishell_history");
 
   while (running) {
+    // Report the background jobs that finished meanwhile
+    job_notify(STDERR_FILENO);
+
     // Display prompt and get input
-    input = readline(prompt);
+    input = read_line(prompt);
 
     // Handle EOF (Ctrl+D)
     if (!input) {
@@ -103,7 +123,10 @@ void repl_start(t_hashmap *environment) {
 
     if (running && input[0] != '\0') {
       // Process the input
-      process_input(input, environment);
+      char *heredoc_line = NULL;
+      script_execute(input, read_heredoc_line, &heredoc_line, environment,
+                     arena);
+      free(heredoc_line);
     }
 
     free(input);
@@ -111,4 +134,6 @@ void repl_start(t_hashmap *environment) {
 
   // Save command history
   write_history(".minishell_history");
+
+  arena_free(arena);
 }
@@ -1,8 +1,8 @@
 #ifndef REPL_H
 #define REPL_H
 
-#include "ft_hashmap.h"
+#include "environment/environment.h"
 
-void repl_start(t_hashmap *environment);
+void repl_start(t_environment *environment);
 
 #endif
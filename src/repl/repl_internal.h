@@ -1,6 +1,16 @@
 #ifndef REPL_INTERNAL_H
 #define REPL_INTERNAL_H
 
+/**
+ * @brief Size of the chunks of the per-line arena.
+ */
+#define REPL_ARENA_CHUNK_SIZE 16384
+
+/**
+ * @brief Prompt shown while reading the body of a here-document.
+ */
+#define REPL_HEREDOC_PROMPT "> "
+
 /**
  * @brief Sets up signal handlers for the REPL.
  */
@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+
+#include "script.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena/arena.h"
+#include "ast/ast.h"
+#include "cache/cache.h"
+#include "evaluator/evaluator.h"
+#include "ft_stdlib.h"
+#include "heredoc/heredoc.h"
+#include "lexer/lexer.h"
+#include "minishell.h"
+#include "parser/parser.h"
+#include "script_internal.h"
+
+/**
+ * @brief Checks whether `input` holds no command: only blanks, or a
+ * comment such as the `#!` line of a script.
+ */
+static bool script_is_empty(const char *input) {
+  input += strspn(input, " \t\v\f\r");
+  return *input == '\0' || *input == '#';
+}
+
+bool script_parse(const char *input, size_t length, size_t line,
+                  t_script_command *command, bool *error, t_arena *arena) {
+  bool admit;
+
+  *command = (t_script_command){
+      .entry = parser_cache_acquire(input, line, &admit),
+  };
+  *error = false;
+  if (command->entry) {
+    command->length = line;
+    return true;
+  }
+
+  // A tree the cache will not take lives no longer than the command
+  if (admit) command->arena = arena_new(PARSER_CACHE_CHUNK_SIZE);
+  t_arena *tree_arena = admit ? command->arena : arena;
+  t_lexer *lexer = lexer_new_range(tree_arena, input, length);
+  t_parser *parser = parser_new(tree_arena, lexer);
+  command->tree = parser_parse(parser);
+  if (!command->tree) {
+    *error = parser_has_error(parser);
+    if (command->arena) arena_free(command->arena);
+    return false;
+  }
+
+  // Only a command spanning the whole key may be found by it again; it is
+  // cached compiled, ready to run
+  command->length = lexer_offset(lexer);
+  if (admit && command->length == line &&
+      parser_cache_fits(arena_used(command->arena))) {
+    t_program *program = evaluator_compile(command->tree, command->arena);
+    command->entry = parser_cache_insert(input, line, command->tree, program,
+                                         command->arena);
+  }
+  return true;
+}
+
+void script_run_command(t_script_command *command,
+                        t_heredoc_reader read_line, void *context,
+                        t_environment *environment, t_arena *arena) {
+  if (command->entry) {
+    const t_program *program = parser_cache_data(command->entry);
+#ifdef MINISHELL_DEBUG
+    evaluator_program_print(program);
+#endif
+    evaluator_run(program, environment, arena);
+    parser_cache_release(command->entry);
+  } else {
+    script_evaluate(command->tree, read_line, context, environment, arena);
+    if (command->arena) arena_free(command->arena);
+  }
+}
+
+bool script_execute(const char *input, t_heredoc_reader read_line,
+                    void *context, t_environment *environment,
+                    t_arena *arena) {
+  if (script_is_empty(input)) return true;
+
+  size_t length = strlen(input);
+  t_script_command command;
+  bool error;
+  bool parsed =
+      script_parse(input, length, length, &command, &error, arena);
+  if (parsed) {
+    script_run_command(&command, read_line, context, environment, arena);
+  } else {
+    environment->status = SCRIPT_STATUS_USAGE;
+  }
+
+  arena_reset(arena);
+  return parsed;
+}
+
+void script_evaluate(t_ast *ast, t_heredoc_reader read_line, void *context,
+                     t_environment *environment, t_arena *arena) {
+  if (!heredoc_collect(ast, read_line, context, environment)) {
+    heredoc_close(ast);
+    environment->status = EXIT_FAILURE;
+    return;
+  }
+
+#ifdef MINISHELL_DEBUG
+  // Print the AST for debugging purposes
+  ast_print(ast);
+#endif
+
+  // Evaluate the AST; `$?` is kept up to date by the evaluator
+  evaluator_evaluate(ast, environment, arena);
+  heredoc_close(ast);
+}
+
+/**
+ * @brief Executes every line `reader` yields.
+ *
+ * Nothing interactive is set up: no line editing, history or signal
+ * handlers, so the first command starts as early as possible.
+ */
+static int script_run(t_script_reader *reader, t_environment *environment) {
+  t_arena *arena = arena_new(SCRIPT_ARENA_CHUNK_SIZE);
+  char *line;
+
+  // A syntax error ends the script, as in a non-interactive POSIX sh
+  while ((line = script_read_line(reader))) {
+    script_release(reader);
+    if (!script_execute(line, script_read_heredoc_line, reader, environment,
+                        arena)) {
+      break;
+    }
+  }
+
+  arena_free(arena);
+  if (reader->owned) free(reader->buffer);
+  return environment->status;
+}
+
+int script_run_string(const char *command, t_environment *environment) {
+  t_script_source source = {
+      .input = command,
+      .length = strlen(command),
+  };
+
+  return script_run_source(&source, NULL, environment);
+}
+
+int script_run_file(const char *path, t_environment *environment) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    int error = errno;
+    fprintf(stderr, MINISHELL_NAME ": %s: %s\n", path, strerror(error));
+    return error == ENOENT ? EVALUATOR_STATUS_NOT_FOUND
+                           : EVALUATOR_STATUS_NOT_EXECUTABLE;
+  }
+
+  // A directory opens fine, but is not a script
+  struct stat st;
+  bool known = fstat(fd, &st) == 0;
+  if (known && S_ISDIR(st.st_mode)) {
+    fprintf(stderr, MINISHELL_NAME ": %s: %s\n", path, strerror(EISDIR));
+    close(fd);
+    return EVALUATOR_STATUS_NOT_EXECUTABLE;
+  }
+  if (!known || !S_ISREG(st.st_mode)) {
+    int status = script_run_fd(fd, environment);
+    close(fd);
+    return status;
+  }
+
+  // A valid compiled form is all a run needs; the script is not even read
+  char directory[PATH_MAX];
+  char absolute[PATH_MAX];
+  bool cached = st.st_size <= SCRIPT_CACHE_MAX_SIZE &&
+                script_cache_directory(environment, directory,
+                                       sizeof(directory)) &&
+                realpath(path, absolute);
+  t_cache *cache = cached ? cache_open(directory, absolute, &st) : NULL;
+  if (cache) {
+    close(fd);
+    return script_run_cache(cache, environment);
+  }
+
+  // Otherwise it is lexed straight from the page cache
+  t_script_source source;
+  int status;
+  if (!script_map(fd, &st, &source)) {
+    status = script_run_fd(fd, environment);
+    close(fd);
+    return status;
+  }
+  close(fd);
+  t_script_image image = {
+      .writer = cached ? cache_writer_new() : NULL,
+      .directory = directory,
+      .path = absolute,
+      .st = &st,
+  };
+  status = script_run_source(&source, &image, environment);
+  script_unmap(&source);
+  return status;
+}
+
+int script_run_fd(int fd, t_environment *environment) {
+  // Commands inherit the standard input, so they must find it positioned
+  // after the lines run so far; a pipe cannot be rewound, and the input the
+  // shell read ahead of a command is not seen by it.
+  t_script_reader reader = {
+      .fd = fd,
+      .buffer = ft_expect(malloc(SCRIPT_READ_SIZE + 1), __func__),
+      .capacity = SCRIPT_READ_SIZE + 1,
+      .owned = true,
+      .shared = fd == STDIN_FILENO && lseek(fd, 0, SEEK_CUR) >= 0,
+  };
+
+  return script_run(&reader, environment);
+}
@@ -0,0 +1,56 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdbool.h>
+
+#include "arena/arena.h"
+#include "environment/environment.h"
+#include "heredoc/heredoc.h"
+
+/**
+ * @brief Exit status of a syntax error or a misused option, as in POSIX sh.
+ */
+#define SCRIPT_STATUS_USAGE 2
+
+/**
+ * @brief Lexes, parses and evaluates one line of input.
+ *
+ * Blank lines and lines starting with `#` are skipped. Here-document bodies
+ * are read with `read_line`. Everything allocated for the line comes from
+ * `arena`, which is reset before returning.
+ *
+ * @return false on a syntax error, which sets the status to
+ * `SCRIPT_STATUS_USAGE`.
+ */
+bool script_execute(const char *input, t_heredoc_reader read_line,
+                    void *context, t_environment *environment,
+                    t_arena *arena);
+
+/**
+ * @brief Runs the commands of `command`, as given to `-c`.
+ *
+ * @return The exit status of the last command.
+ */
+int script_run_string(const char *command, t_environment *environment);
+
+/**
+ * @brief Runs the script at `path`.
+ *
+ * A regular file is mapped and lexed in place one complete command at a
+ * time, so neither memory use nor the start of the first command depends on
+ * its size.
+ *
+ * @return The exit status of the last command, or 126 or 127 if the file
+ * could not be opened or is a directory.
+ */
+int script_run_file(const char *path, t_environment *environment);
+
+/**
+ * @brief Runs the commands read from `fd` until its end or a syntax error,
+ * one line at a time.
+ *
+ * @return The exit status of the last command.
+ */
+int script_run_fd(int fd, t_environment *environment);
+
+#endif
@@ -0,0 +1,48 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena/arena.h"
+#include "cache/cache.h"
+#include "script_internal.h"
+
+bool script_cache_directory(const t_environment *environment, char *buffer,
+                            size_t size) {
+  const char *directory = environment_get(environment, SCRIPT_CACHE_VARIABLE);
+  const char *base;
+  int length;
+
+  // An empty directory turns the cache off
+  if (directory) {
+    length = snprintf(buffer, size, "%s", directory);
+  } else if ((base = environment_get(environment, "XDG_CACHE_HOME")) &&
+             *base) {
+    length = snprintf(buffer, size, "%s/" SCRIPT_CACHE_NAME, base);
+  } else if ((base = environment_get(environment, "HOME")) && *base) {
+    length = snprintf(buffer, size, "%s/.cache/" SCRIPT_CACHE_NAME, base);
+  } else {
+    return false;
+  }
+  return length > 0 && (size_t)length < size;
+}
+
+int script_run_cache(t_cache *cache, t_environment *environment) {
+  t_arena *arena = arena_new(SCRIPT_ARENA_CHUNK_SIZE);
+  t_cache_command command;
+
+  while (cache_next(cache, arena, &command)) {
+    t_script_source bodies = {
+        .input = command.bodies,
+        .length = command.bodies_length,
+    };
+    script_evaluate(command.ast, script_source_read_line, &bodies,
+                    environment, arena);
+    arena_reset(arena);
+  }
+  if (cache_failed(cache)) environment->status = SCRIPT_STATUS_USAGE;
+
+  arena_free(arena);
+  cache_close(cache);
+  return environment->status;
+}
@@ -0,0 +1,202 @@
+#ifndef SCRIPT_INTERNAL_H
+#define SCRIPT_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "arena/arena.h"
+#include "ast/ast.h"
+#include "cache/cache.h"
+#include "environment/environment.h"
+#include "heredoc/heredoc.h"
+#include "parser/parser.h"
+#include "script.h"
+
+/**
+ * @brief Size of the reads a script is loaded with.
+ */
+#define SCRIPT_READ_SIZE 65536
+
+/**
+ * @brief Size of the chunks of the per-line arena.
+ */
+#define SCRIPT_ARENA_CHUNK_SIZE 16384
+
+/**
+ * @brief Granularity at which the pages of a mapped script that were run are
+ * dropped.
+ */
+#define SCRIPT_RELEASE_SIZE (1 << 20)
+
+/**
+ * @brief Size up to which a script file is compiled as it runs and cached.
+ */
+#define SCRIPT_CACHE_MAX_SIZE (4 << 20)
+
+/**
+ * @brief Variable naming the directory compiled scripts are cached in; set
+ * but empty, it turns the cache off.
+ */
+#define SCRIPT_CACHE_VARIABLE "MINISHELL_CACHE_DIR"
+
+/**
+ * @brief Name of the cache directory under `XDG_CACHE_HOME` or
+ * `~/.cache`.
+ */
+#define SCRIPT_CACHE_NAME "minishell"
+
+/**
+ * @brief A script held in memory as a whole, such as a mapped file.
+ *
+ * `offset` is where the next command starts. Up to `released`, the pages of
+ * a `mapped` script were already handed back to the kernel.
+ */
+typedef struct s_script_source {
+  const char *input;
+  size_t length;
+  size_t offset;
+  size_t released;
+  bool mapped;
+} t_script_source;
+
+/**
+ * @brief The compiled form of a script being built while it runs, to be
+ * stored in `directory` once its last command was added.
+ */
+typedef struct s_script_image {
+  t_cache_writer *writer;
+  const char *directory;
+  const char *path;
+  const struct stat *st;
+} t_script_image;
+
+/**
+ * @brief Splits buffered input into lines.
+ *
+ * `buffer[start, end)` holds the input read but not consumed yet. `fd` is -1
+ * once the end of the input was reached, or when the whole input was given
+ * upfront. `shared` marks a seekable descriptor the commands may read from
+ * too, to which unconsumed input is handed back before each command.
+ */
+typedef struct s_script_reader {
+  int fd;
+  char *buffer;
+  size_t start;
+  size_t end;
+  size_t capacity;
+  bool owned;
+  bool shared;
+} t_script_reader;
+
+/**
+ * @brief A command parsed from the start of an input.
+ *
+ * A tree shared through the parse cache is held by `entry`; any other one is
+ * `tree`, parsed into its own `arena` if it was meant to be cached, or else
+ * into the caller's. `length` is the input it spans, without its
+ * here-document bodies.
+ */
+typedef struct s_script_command {
+  t_parser_cache_entry *entry;
+  t_ast *tree;
+  t_arena *arena;
+  size_t length;
+} t_script_command;
+
+/**
+ * @brief Parses the first complete command of `input`, looking it up in the
+ * parse cache by its first `line` bytes and caching it when it spans exactly
+ * those and was missed before.
+ *
+ * A tree that is not to be cached is parsed into `arena`, which must outlive
+ * the command.
+ *
+ * @return false at the end of the input or on a syntax error, which
+ * `*error` tells apart.
+ */
+bool script_parse(const char *input, size_t length, size_t line,
+                  t_script_command *command, bool *error, t_arena *arena);
+
+/**
+ * @brief Runs a command filled by `script_parse`, then lets go of its tree.
+ */
+void script_run_command(t_script_command *command,
+                        t_heredoc_reader read_line, void *context,
+                        t_environment *environment, t_arena *arena);
+
+/**
+ * @brief Collects the here-documents of `ast` with `read_line` and evaluates
+ * it.
+ */
+void script_evaluate(t_ast *ast, t_heredoc_reader read_line, void *context,
+                     t_environment *environment, t_arena *arena);
+
+/**
+ * @brief Parses and runs the commands of `source` one complete command at a
+ * time, until its end or a syntax error.
+ *
+ * Each command is also added to `image`, unless it is NULL, which is stored
+ * before the last one runs: the script may well exit from it. A script with
+ * a syntax error is not stored.
+ *
+ * @return The exit status of the last command.
+ */
+int script_run_source(t_script_source *source, t_script_image *image,
+                      t_environment *environment);
+
+/**
+ * @brief Reads a line of a here-document body from `source`, right after the
+ * command it belongs to.
+ */
+const char *script_source_read_line(void *context, size_t *length);
+
+/**
+ * @brief Maps the regular file open at `fd`, described by `st`, into
+ * `source`.
+ *
+ * @return false if it could not be mapped.
+ */
+bool script_map(int fd, const struct stat *st, t_script_source *source);
+
+/**
+ * @brief Unmaps a source filled by `script_map`.
+ */
+void script_unmap(t_script_source *source);
+
+/**
+ * @brief Builds the path of the directory compiled scripts are cached in.
+ *
+ * @return false if the cache is off or the path does not fit.
+ */
+bool script_cache_directory(const t_environment *environment, char *buffer,
+                            size_t size);
+
+/**
+ * @brief Runs the commands of a compiled script, then closes it.
+ *
+ * @return The exit status of the last command.
+ */
+int script_run_cache(t_cache *cache, t_environment *environment);
+
+/**
+ * @brief Returns the next line, without its newline and terminated in place.
+ *
+ * The line stays valid until the next read.
+ *
+ * @return The line, or NULL at the end of the input.
+ */
+char *script_read_line(t_script_reader *reader);
+
+/**
+ * @brief Hands the input read ahead back to a shared descriptor, so a
+ * command reading it starts right after the current line.
+ */
+void script_release(t_script_reader *reader);
+
+/**
+ * @brief Reads a line of a here-document body from the script.
+ */
+const char *script_read_heredoc_line(void *context, size_t *length);
+
+#endif
@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ft_stdlib.h"
+#include "minishell.h"
+#include "script_internal.h"
+
+/**
+ * @brief Appends the next chunk of the input to the buffer, moving the
+ * unconsumed input to its front first.
+ *
+ * One byte is always kept free, so the last line can be terminated in place
+ * even without a newline.
+ *
+ * @return false at the end of the input or on a read error.
+ */
+static bool script_fill(t_script_reader *reader) {
+  if (reader->fd < 0) return false;
+
+  if (reader->start > 0) {
+    memmove(reader->buffer, reader->buffer + reader->start,
+            reader->end - reader->start);
+    reader->end -= reader->start;
+    reader->start = 0;
+  }
+  if (reader->capacity - reader->end < SCRIPT_READ_SIZE + 1) {
+    reader->capacity = reader->end + SCRIPT_READ_SIZE + 1;
+    reader->buffer =
+        ft_expect(realloc(reader->buffer, reader->capacity), __func__);
+  }
+
+  ssize_t length;
+  do {
+    length = read(reader->fd, reader->buffer + reader->end, SCRIPT_READ_SIZE);
+  } while (length < 0 && errno == EINTR);
+
+  if (length < 0) {
+    fprintf(stderr, MINISHELL_NAME ": read: %s\n", strerror(errno));
+  }
+  if (length <= 0) {
+    reader->fd = -1;
+    return false;
+  }
+  reader->end += (size_t)length;
+  return true;
+}
+
+char *script_read_line(t_script_reader *reader) {
+  size_t scanned = 0;
+  char *newline;
+
+  // Only the bytes appended by each read are searched
+  while (!(newline = memchr(reader->buffer + reader->start + scanned, '\n',
+                            reader->end - reader->start - scanned))) {
+    scanned = reader->end - reader->start;
+    if (!script_fill(reader)) break;
+  }
+  if (reader->start == reader->end) return NULL;
+
+  char *line = reader->buffer + reader->start;
+  size_t stop = newline ? (size_t)(newline - reader->buffer) : reader->end;
+  reader->buffer[stop] = '\0';
+  reader->start = newline ? stop + 1 : stop;
+  return line;
+}
+
+void script_release(t_script_reader *reader) {
+  if (!reader->shared || reader->fd < 0 || reader->start == reader->end) {
+    return;
+  }
+  if (lseek(reader->fd, -(off_t)(reader->end - reader->start), SEEK_CUR) >=
+      0) {
+    reader->start = reader->end;
+  }
+}
+
+const char *script_read_heredoc_line(void *context, size_t *length) {
+  const char *line = script_read_line(context);
+
+  if (line) *length = strlen(line);
+  return line;
+}
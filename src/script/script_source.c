@@ -0,0 +1,162 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "arena/arena.h"
+#include "cache/cache.h"
+#include "heredoc/heredoc.h"
+#include "parser/parser.h"
+#include "script_internal.h"
+
+/**
+ * @brief Drops the pages of a mapped script the commands run so far came
+ * from; they are never read again, so memory use stays flat on long scripts.
+ */
+static void script_source_release(t_script_source *source) {
+  size_t end = source->offset / SCRIPT_RELEASE_SIZE * SCRIPT_RELEASE_SIZE;
+
+  if (!source->mapped || end <= source->released) return;
+  madvise((char *)source->input + source->released, end - source->released,
+          MADV_DONTNEED);
+  source->released = end;
+}
+
+/**
+ * @brief Moves `source` past the blank and comment lines ahead, which are
+ * not worth a lookup in the parse cache.
+ */
+static void script_source_skip(t_script_source *source) {
+  while (source->offset < source->length) {
+    const char *line = source->input + source->offset;
+    size_t rest = source->length - source->offset;
+    size_t blanks = 0;
+
+    while (blanks < rest && (line[blanks] == ' ' || line[blanks] == '\t')) {
+      ++blanks;
+    }
+    if (blanks < rest && line[blanks] != '\n' && line[blanks] != '#') return;
+
+    const char *newline = memchr(line + blanks, '\n', rest - blanks);
+    source->offset += newline ? (size_t)(newline - line) + 1 : rest;
+  }
+}
+
+/**
+ * @brief Adds the command `source` was just moved past to `image`, with the
+ * text of its here-document bodies, which it has not read yet.
+ *
+ * Once the command is the last one, the image is complete and stored: it is
+ * not left to the end of the run, which the command may never return from.
+ */
+static void script_source_compile(t_script_source *source,
+                                  const t_script_command *command,
+                                  t_script_image *image) {
+  t_script_source rest = *source;
+  const t_ast *ast = command->tree;
+
+  // The copy only looks ahead, so it must not drop any page
+  rest.mapped = false;
+
+  // Trees with here-documents are never shared through the parse cache
+  if (command->entry) {
+    ast = parser_cache_ast(command->entry);
+  } else {
+    heredoc_skip(command->tree, script_source_read_line, &rest);
+  }
+  bool added = cache_writer_add(image->writer, ast,
+                                source->input + source->offset,
+                                rest.offset - source->offset);
+
+  script_source_skip(&rest);
+
+  // A script too deep to compile is still run from its text
+  if (!added) {
+    cache_writer_discard(image->writer);
+  } else if (rest.offset >= rest.length) {
+    cache_writer_finish(image->writer, image->directory, image->path,
+                        image->st);
+  } else {
+    return;
+  }
+  image->writer = NULL;
+}
+
+int script_run_source(t_script_source *source, t_script_image *image,
+                      t_environment *environment) {
+  t_arena *arena = arena_new(SCRIPT_ARENA_CHUNK_SIZE);
+  t_script_command command;
+  bool error = false;
+
+  while ((script_source_skip(source), source->offset < source->length)) {
+    // Lines are cached with their newline: without it, one ending in a
+    // backslash or an open quote would mean something else
+    const char *input = source->input + source->offset;
+    size_t rest = source->length - source->offset;
+    const char *newline = memchr(input, '\n', rest);
+    size_t line = newline ? (size_t)(newline - input) + 1 : rest;
+
+    // A syntax error ends the script, as in a non-interactive POSIX sh
+    if (!script_parse(input, rest, line, &command, &error, arena)) {
+      if (error) environment->status = SCRIPT_STATUS_USAGE;
+      break;
+    }
+
+    // Here-document bodies follow the command, and are skipped with it
+    source->offset += command.length;
+    if (image && image->writer) script_source_compile(source, &command, image);
+    script_run_command(&command, script_source_read_line, source, environment,
+                       arena);
+    arena_reset(arena);
+    script_source_release(source);
+  }
+
+  // The commands before a syntax error ran, but such a script is not stored;
+  // one without any command is
+  if (image && image->writer) {
+    if (error) {
+      cache_writer_discard(image->writer);
+    } else {
+      cache_writer_finish(image->writer, image->directory, image->path,
+                          image->st);
+    }
+  }
+  arena_free(arena);
+  return environment->status;
+}
+
+const char *script_source_read_line(void *context, size_t *length) {
+  t_script_source *source = context;
+
+  if (source->offset >= source->length) return NULL;
+
+  const char *line = source->input + source->offset;
+  size_t rest = source->length - source->offset;
+  const char *newline = memchr(line, '\n', rest);
+  *length = newline ? (size_t)(newline - line) : rest;
+
+  // The pages of the line are released only once the next one is read
+  script_source_release(source);
+  source->offset += newline ? *length + 1 : *length;
+  return line;
+}
+
+bool script_map(int fd, const struct stat *st, t_script_source *source) {
+  *source = (t_script_source){.input = "", .length = 0};
+  if (st->st_size == 0) return true;
+
+  void *map = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) return false;
+  madvise(map, (size_t)st->st_size, MADV_SEQUENTIAL);
+
+  source->input = map;
+  source->length = (size_t)st->st_size;
+  source->mapped = true;
+  return true;
+}
+
+void script_unmap(t_script_source *source) {
+  if (source->mapped) munmap((char *)source->input, source->length);
+}
@@ -10,6 +10,7 @@ typedef enum e_token_type {
   TOKEN_WORD,
   TOKEN_NEWLINE,
   TOKEN_SEMI,
+  TOKEN_AMP,
   TOKEN_AND_IF,
   TOKEN_OR_IF,
   TOKEN_PIPE,
@@ -21,14 +22,66 @@ typedef enum e_token_type {
   TOKEN_DGREAT,
 } t_token_type;
 
+typedef enum e_word_segment_type {
+  WORD_SEGMENT_LITERAL,
+  WORD_SEGMENT_PARAMETER,
+  WORD_SEGMENT_STATUS,
+  WORD_SEGMENT_SHELL_PID,
+  WORD_SEGMENT_LAST_PID,
+  WORD_SEGMENT_ANY_STRING,
+  WORD_SEGMENT_ANY_CHAR,
+  WORD_SEGMENT_BRACKET,
+} t_word_segment_type;
+
+/**
+ * @brief A piece of a word: literal text with quotes already removed, the
+ * name of the parameter expanded in its place, or an unquoted pattern
+ * character: `*`, `?` or a whole `[...]` bracket expression.
+ *
+ * `text` is not NUL-terminated; `$?`, `$$` and `$!` have no text, and a
+ * pattern character's text is its source.
+ */
+typedef struct s_word_segment {
+  t_word_segment_type type;
+  const char *text;
+  size_t length;
+} t_word_segment;
+
+/**
+ * @brief How to assemble a word that expands parameters or pathnames.
+ *
+ * A word without any quoted part that expands to nothing is dropped from
+ * its command. `glob` is set when a segment is a pattern character.
+ */
+typedef struct s_word_expansion {
+  const t_word_segment *segments;
+  size_t count;
+  bool quoted;
+  bool glob;
+} t_word_expansion;
+
+/**
+ * @brief A lexical token.
+ *
+ * Operator tokens are shared static singletons (see `token_operator`). Word
+ * tokens describe a span of the lexer input through `offset` and `length`;
+ * their `literal` points into a NUL-separated buffer owned by the lexer and
+ * has its quotes removed. `expansion` is NULL unless the word expands
+ * parameters or pathnames; the literal then still spells them out, as in
+ * `$HOME` or `*.c`. `quoted` is set when any part of the word was quoted or
+ * escaped.
+ */
 typedef struct s_token {
   t_token_type type;
   const char* literal;
+  size_t offset;
+  size_t length;
+  const t_word_expansion* expansion;
+  bool quoted;
 } t_token;
 
-t_token* token_new(t_token token);
-void token_free(t_token* token);
+const t_token* token_operator(t_token_type type);
 const char* token_type_to_string(t_token_type type);
-void token_print(t_token* token);
+void token_print(const t_token* token);
 
 #endif
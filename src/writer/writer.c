@@ -0,0 +1,85 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "writer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes every byte of `iov`, resuming after short writes and signal
+ * interruptions.
+ *
+ * @return 0 on success, or -1 with `errno` set.
+ */
+static int writer_writev_all(int fd, struct iovec *iov, int count) {
+  while (count > 0) {
+    ssize_t written = writev(fd, iov, count);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+
+    // Drop what was written; a short write resumes mid-vector
+    while (count > 0 && (size_t)written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = (char *)iov->iov_base + written;
+      iov->iov_len -= written;
+    }
+  }
+  return 0;
+}
+
+void writer_init(t_writer *writer, int fd) {
+  writer->fd = fd;
+  writer->error = 0;
+  writer->length = 0;
+}
+
+void writer_write(t_writer *writer, const char *data, size_t length) {
+  if (writer->error) return;
+
+  if (length <= WRITER_BUFFER_SIZE - writer->length) {
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+    return;
+  }
+
+  struct iovec iov[2] = {
+      {.iov_base = writer->buffer, .iov_len = writer->length},
+      {.iov_base = (char *)data, .iov_len = length},
+  };
+  if (writer_writev_all(writer->fd, iov, 2) == -1) writer->error = errno;
+  writer->length = 0;
+}
+
+void writer_puts(t_writer *writer, const char *str) {
+  writer_write(writer, str, strlen(str));
+}
+
+void writer_putc(t_writer *writer, char c) {
+  if (writer->length < WRITER_BUFFER_SIZE) {
+    writer->buffer[writer->length++] = c;
+  } else {
+    writer_write(writer, &c, 1);
+  }
+}
+
+int writer_flush(t_writer *writer) {
+  if (!writer->error && writer->length > 0) {
+    struct iovec iov = {.iov_base = writer->buffer, .iov_len = writer->length};
+    if (writer_writev_all(writer->fd, &iov, 1) == -1) writer->error = errno;
+  }
+  writer->length = 0;
+
+  if (writer->error) {
+    errno = writer->error;
+    return -1;
+  }
+  return 0;
+}
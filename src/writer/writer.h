@@ -0,0 +1,50 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h>
+
+#define WRITER_BUFFER_SIZE 4096
+
+/**
+ * @brief A buffered writer on a file descriptor.
+ *
+ * Output is collected in `buffer` and handed to the kernel in as few system
+ * calls as possible: a piece that does not fit goes out together with the
+ * buffer in a single `writev`. The first error is kept and every later write
+ * is dropped.
+ */
+typedef struct s_writer {
+  int fd;
+  int error;
+  size_t length;
+  char buffer[WRITER_BUFFER_SIZE];
+} t_writer;
+
+/**
+ * @brief Starts an empty writer on `fd`, which stays owned by the caller.
+ */
+void writer_init(t_writer *writer, int fd);
+
+/**
+ * @brief Appends `length` bytes of `data`.
+ */
+void writer_write(t_writer *writer, const char *data, size_t length);
+
+/**
+ * @brief Appends a NUL-terminated string.
+ */
+void writer_puts(t_writer *writer, const char *str);
+
+/**
+ * @brief Appends a single character.
+ */
+void writer_putc(t_writer *writer, char c);
+
+/**
+ * @brief Writes out whatever is still buffered.
+ *
+ * @return 0 on success, or -1 with `errno` set if any write failed.
+ */
+int writer_flush(t_writer *writer);
+
+#endif
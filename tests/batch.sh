@@ -0,0 +1,30 @@
+#!/bin/sh
+# Commands given with -c, as a script file or on a piped standard input.
+
+. "$(dirname "$0")/lib/check.sh"
+
+check "-c" 0 "a
+b" "$shell" -c 'echo a; echo b'
+check "-c status" 3 "" "$shell" -c 'sh -c "exit 3"'
+check "-c syntax error" 2 "minishell: syntax error near unexpected token \`)'" \
+  "$shell" -c 'echo a )'
+
+printf 'echo one\nfalse\n' >"$scratch/script"
+check "script" 1 "one" "$shell" "$scratch/script"
+check "missing script" 127 \
+  "minishell: $scratch/missing: No such file or directory" \
+  "$shell" "$scratch/missing"
+mkdir "$scratch/directory"
+check "directory script" 126 "minishell: $scratch/directory: Is a directory" \
+  "$shell" "$scratch/directory"
+
+printf 'echo one\necho (\necho two\n' >"$scratch/broken"
+expected="one
+minishell: syntax error near unexpected token \`('"
+check "script syntax error" 2 "$expected" "$shell" "$scratch/broken"
+check "piped syntax error" 2 "$expected" \
+  sh -c 'cat "$2" | "$1"' sh "$shell" "$scratch/broken"
+check "piped status" 1 "one" \
+  sh -c '"$1" <"$2"' sh "$shell" "$scratch/script"
+
+finish
@@ -0,0 +1,19 @@
+#!/bin/sh
+# `exit` and `export`, which shell scripts hand their results through.
+
+. "$(dirname "$0")/lib/check.sh"
+
+check "exit with a status" 7 "" "$shell" -c 'exit 7'
+check "exit with the last status" 1 "" "$shell" -c 'false; exit'
+check "exit wraps its status" 44 "" "$shell" -c 'exit 300'
+check "exit with a word" 2 "minishell: exit: abc: numeric argument required" \
+  "$shell" -c 'exit abc'
+check "exit with two operands" 0 "minishell: exit: too many arguments
+after" "$shell" -c 'exit 1 2; echo after'
+check "exit in a pipeline" 0 "after 0" \
+  "$shell" -c 'exit 3 | cat; echo after $?'
+check "export" 0 "bar" "$shell" -c 'export FOO=bar; export FOO; echo $FOO'
+check "export a bad name" 1 "minishell: export: \`1x': not a valid identifier" \
+  "$shell" -c 'export 1x; exit'
+
+finish
@@ -0,0 +1,57 @@
+#!/bin/sh
+# A script runs the same from its compiled image as on the run compiling it,
+# which streams its commands and stores the image only if it parses whole.
+# Usage: cache.sh <minishell>
+
+set -u
+
+. "$(dirname "$0")/lib/check.sh"
+
+images() {
+  find "$MINISHELL_CACHE_DIR" -name '*.msc' 2>/dev/null | wc -l | tr -d ' '
+}
+
+printf 'echo a\ncat <<EOF\nx $HOME\nEOF\necho b\nexit 3\n' >"$scratch/exits"
+expected="a
+x $HOME
+b"
+check "cold run" 3 "$expected" "$shell" "$scratch/exits"
+check "stored before the last command" 0 1 images
+check "warm run" 3 "$expected" "$shell" "$scratch/exits"
+
+printf 'echo one\necho two |\n' >"$scratch/broken"
+expected="one
+minishell: syntax error: unexpected end of file"
+check "syntax error" 2 "$expected" "$shell" "$scratch/broken"
+check "syntax error not stored" 0 1 images
+
+: >"$scratch/empty"
+check "empty script" 0 "" "$shell" "$scratch/empty"
+check "empty script stored" 0 2 images
+
+# A damaged image is compiled again, not run as it reads
+printf 'echo alpha\n' >"$scratch/damaged"
+"$shell" "$scratch/damaged" >/dev/null
+image=$(grep -l alpha "$MINISHELL_CACHE_DIR"/*.msc)
+offset=$(grep -oba alpha "$image" | cut -d: -f1)
+printf X | dd of="$image" bs=1 seek=$((offset + 4)) conv=notrunc 2>/dev/null
+check "damaged image" 0 alpha "$shell" "$scratch/damaged"
+check "damaged image replaced" 0 alpha \
+  sh -c 'grep -oa alpha "$1"' sh "$image"
+
+# Storing an image evicts the least recently used past the bound
+i=0
+while [ "$i" -lt 300 ]; do
+  touch -t 202001010000 "$MINISHELL_CACHE_DIR/old$i.msc"
+  i=$((i + 1))
+done
+touch -t 202001010000 "$MINISHELL_CACHE_DIR/interrupted.msc.abcdef"
+printf 'echo new\n' >"$scratch/new"
+check "evicting run" 0 new "$shell" "$scratch/new"
+check "images bounded" 0 256 images
+check "new image kept" 0 1 \
+  sh -c 'grep -l new "$1"/*.msc | wc -l | tr -d " "' sh "$MINISHELL_CACHE_DIR"
+check "interrupted store removed" 0 0 \
+  sh -c 'ls "$1" | grep abcdef | wc -l | tr -d " "' sh "$MINISHELL_CACHE_DIR"
+
+finish
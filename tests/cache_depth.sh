@@ -0,0 +1,36 @@
+#!/bin/sh
+# A script nesting deeper than a compiled image may must run the same on
+# every run: it is never cached, and runs from its text instead.
+# Usage: cache_depth.sh <minishell>
+
+set -u
+
+shell=$1
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+
+script=$directory/deep.sh
+depth=1100
+i=0
+line=
+while [ "$i" -lt "$depth" ]; do
+  line="($line"
+  i=$((i + 1))
+done
+line="${line}echo deep"
+i=0
+while [ "$i" -lt "$depth" ]; do
+  line="$line)"
+  i=$((i + 1))
+done
+printf '%s\necho after\n' "$line" >"$script"
+
+expected=$(printf 'deep\nafter')
+for run in 1 2; do
+  output=$(MINISHELL_CACHE_DIR=$directory/cache "$shell" "$script" 2>&1)
+  status=$?
+  if [ "$status" -ne 0 ] || [ "$output" != "$expected" ]; then
+    echo "cache_depth: run $run exited $status: $output" >&2
+    exit 1
+  fi
+done
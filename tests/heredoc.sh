@@ -0,0 +1,27 @@
+#!/bin/sh
+# Here-document bodies expand parameters unless their delimiter is quoted.
+
+. "$(dirname "$0")/lib/check.sh"
+
+cat >"$scratch/heredoc.sh" <<'SCRIPT'
+export X=val
+cat <<EOF
+$X ${X}y "$X" '$X' \$X \\ \q
+EOF
+cat <<"EOF"
+$X
+EOF
+cat <<E\OF
+$X
+EOF
+SCRIPT
+expected='val valy "val" '\''val'\'' $X \ \q
+$X
+$X'
+
+check "from a file" 0 "$expected" "$shell" "$scratch/heredoc.sh"
+check "from a cached file" 0 "$expected" "$shell" "$scratch/heredoc.sh"
+check "from standard input" 0 "$expected" \
+  sh -c '"$1" <"$2"' sh "$shell" "$scratch/heredoc.sh"
+
+finish
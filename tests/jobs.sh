@@ -0,0 +1,18 @@
+#!/bin/sh
+# Background jobs, as seen from the shell and from its forked children.
+
+. "$(dirname "$0")/lib/check.sh"
+
+running="[1]  Running     sleep 1 > /dev/null &"
+
+check "jobs in a pipeline" 0 "$running" \
+  "$shell" -c 'sleep 1 >/dev/null & jobs | cat; exit 0'
+check "jobs in a subshell" 0 "$running" \
+  "$shell" -c 'sleep 1 >/dev/null & (jobs); exit 0'
+check "wait in a subshell" 0 "127
+0" "$shell" -c 'sleep 1 >/dev/null & (wait %1; echo $?; wait; echo $?); exit 0'
+check "wait for a job" 3 "" "$shell" -c '(sleep 0.1; exit 3) & wait %1'
+check "wait -n" 0 "4" \
+  "$shell" -c '(sleep 0.1; exit 4) & sleep 0.2 & wait -n; echo $?; wait'
+
+finish
@@ -0,0 +1,32 @@
+# Sourced by the tests, which take the shell to test as their argument.
+# Commands run in a private directory, with a private script cache.
+
+shell=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+test=$(basename "$0" .sh)
+scratch=$(mktemp -d)
+trap 'rm -rf "$scratch"' EXIT
+MINISHELL_CACHE_DIR=$scratch/cache
+export MINISHELL_CACHE_DIR
+failures=0
+
+# check <name> <status> <output> <command...>
+# Runs the command, its errors mixed into its output, and compares both.
+check() {
+  check_name=$1
+  check_status=$2
+  check_expected=$3
+  shift 3
+  check_output=$(cd "$scratch" && "$@" 2>&1)
+  check_actual=$?
+  if [ "$check_actual" -ne "$check_status" ] ||
+    [ "$check_output" != "$check_expected" ]; then
+    printf '%s: %s: exited %s, expected %s, with:\n%s\n' "$test" \
+      "$check_name" "$check_actual" "$check_status" "$check_output" >&2
+    failures=$((failures + 1))
+  fi
+}
+
+finish() {
+  [ "$failures" -eq 0 ]
+  exit
+}
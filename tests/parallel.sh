@@ -0,0 +1,21 @@
+#!/bin/sh
+# The parallel builtin: statuses, ordered output, and the descriptors it
+# holds while a slow job delays the output of faster ones.
+
+. "$(dirname "$0")/lib/check.sh"
+
+check "ordered output" 0 "3
+2
+1" "$shell" -c 'parallel -k -j 3 sh -c "sleep 0.{}; echo {}" ::: 3 2 1'
+check "failed jobs" 2 "parallel: [2] exit 1: 1
+parallel: [3] exit 7: 7" \
+  "$shell" -c 'parallel -k -j 2 sh -c "exit {}" ::: 0 1 7'
+
+# Each job done but not printed holds a memory file
+seq 1 1000 >"$scratch/arguments"
+check "slow first job" 0 "$(seq 1 1000)" \
+  sh -c 'ulimit -n 64 && "$1" -c "parallel -k -j 4 -a $2 \
+    sh -c \"[ {} = 1 ] && sleep 0.5; echo {}\""' sh "$shell" \
+  "$scratch/arguments"
+
+finish
@@ -0,0 +1,70 @@
+#!/bin/sh
+# The parse cache takes a line only once it repeats, and a line runs the
+# same whether its tree came from the cache or not.
+# Usage: parse_cache.sh <minishell>
+
+set -u
+
+. "$(dirname "$0")/lib/check.sh"
+
+stats='parsecache | grep -e ^hits -e ^entries'
+
+check "admitted on a repeat" 0 "x
+x
+x
+hits	1
+entries	1" "$shell" -c "echo x
+echo x
+echo x
+$stats"
+
+check "cleared" 0 "x
+x
+x
+hits	0
+entries	0" "$shell" -c "echo x
+echo x
+parsecache -r
+echo x
+$stats"
+
+check "disabled" 0 "x
+x
+x
+hits	0
+entries	0" "$shell" -c "parsecache -s 0
+echo x
+echo x
+echo x
+$stats"
+
+check "usage" 1 "minishell: parsecache: usage: parsecache [-r | -s bytes]" \
+  "$shell" -c 'parsecache -s x'
+
+# Here-documents are read anew each time, so their lines are never cached
+check "here-document" 0 "a
+a
+a
+entries	0" "$shell" -c "cat <<E
+a
+E
+cat <<E
+a
+E
+cat <<E
+a
+E
+parsecache | grep ^entries"
+
+i=0
+lines=
+while [ "$i" -lt 50 ]; do
+  lines="${lines}echo \"line \$?\" '$((i % 3))'; false
+"
+  i=$((i + 1))
+done
+cached=$("$shell" -c "$lines" 2>&1)
+check "same output uncached" 1 "$cached" "$shell" -c "parsecache -s 0
+$lines"
+
+finish
@@ -0,0 +1,35 @@
+#!/bin/sh
+# A command whose redirection cannot be opened is not run, and fails.
+# Usage: redirect.sh <minishell>
+
+set -u
+
+. "$(dirname "$0")/lib/check.sh"
+
+# A command that runs anyway must not wait on the terminal
+exec </dev/null
+
+missing="minishell: missing: No such file or directory"
+unwritable="minishell: /nonexistent/file: No such file or directory"
+
+check "builtin output" 1 "$unwritable" \
+  "$shell" -c 'echo hi >/nonexistent/file'
+check "external output" 1 "$unwritable" \
+  "$shell" -c '/bin/echo hi >/nonexistent/file'
+check "external input" 1 "$missing" "$shell" -c 'cat <missing'
+check "and-or" 0 "$unwritable
+failed" "$shell" -c 'echo hi >/nonexistent/file && echo ran || echo failed'
+check "pipeline stage" 1 "$missing" "$shell" -c 'echo hi | cat <missing'
+check "builtin stage" 1 "$unwritable" \
+  "$shell" -c 'echo a | echo hi >/nonexistent/file'
+check "subshell" 1 "$unwritable" "$shell" -c '(echo hi >/nonexistent/file)'
+
+# Redirections stop at the first that fails
+check "later redirections" 0 "$missing
+1
+absent" "$shell" -c 'cat <missing >created; echo $?
+test -e created || echo absent'
+check "earlier redirections" 0 "$unwritable" \
+  "$shell" -c 'echo hi >truncated >/nonexistent/file; cat truncated'
+
+finish
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Script files are lexed straight from their mapping, one complete command
+# at a time; the disk cache is off here.
+
+. "$(dirname "$0")/lib/check.sh"
+
+run() {
+  env MINISHELL_CACHE_DIR= "$shell" "$@"
+}
+
+printf '#!/bin/minishell\n\n  # comment\necho "a\nb" \\\n  c\n' \
+  >"$scratch/lines"
+check "multi-line commands" 0 "a
+b c" run "$scratch/lines"
+
+printf 'echo last' >"$scratch/unterminated"
+check "no final newline" 0 "last" run "$scratch/unterminated"
+
+: >"$scratch/empty"
+check "empty script" 0 "" run "$scratch/empty"
+
+printf 'cat <<EOF\nbody\nEOF\necho after\n' >"$scratch/heredoc"
+check "here-document" 0 "body
+after" run "$scratch/heredoc"
+
+# A large script still runs its first command, and all that follow
+seq 1 50000 | sed 's/^/echo /' >"$scratch/large"
+check "large script" 0 "1
+50000" sh -c 'env MINISHELL_CACHE_DIR= "$1" "$2" | sed -n "1p;\$p"' sh \
+  "$shell" "$scratch/large"
+
+# Commands read the standard input of the shell, not the script
+printf 'echo start\ncat\n' >"$scratch/stdin"
+check "standard input" 0 "start
+input" sh -c 'echo input | env MINISHELL_CACHE_DIR= "$1" "$2"' sh \
+  "$shell" "$scratch/stdin"
+
+finish
@@ -0,0 +1,21 @@
+#!/bin/sh
+# Only an unquoted `time` opening a pipeline is the reserved word.
+
+. "$(dirname "$0")/lib/check.sh"
+
+check "time" 0 "stage" \
+  sh -c '"$1" -c "time true" 2>&1 | head -n 1 | cut -d " " -f 1' sh "$shell"
+check "time -j" 0 '{"status":3,' \
+  sh -c '"$1" -c "time -j sh -c \"exit 3\"" 2>&1 | cut -d "\"" -f 1-3' \
+  sh "$shell"
+
+# Without a `time` program to find, a quoted one is not found
+unfound="minishell: command not found: time"
+check "double-quoted time" 127 "$unfound" \
+  "$shell" -c 'export PATH=/nonexistent; "time" echo x'
+check "single-quoted time" 127 "$unfound" \
+  "$shell" -c "export PATH=/nonexistent; 'time' echo x"
+check "escaped time" 127 "$unfound" \
+  "$shell" -c 'export PATH=/nonexistent; ti\me echo x'
+
+finish